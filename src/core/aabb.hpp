@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lib/lib.hpp"
+#include "ray_packet.hpp"
 
 class aabb {
 public:
@@ -24,6 +25,12 @@ public:
         return x;
     }
 
+    int longest_axis() const {
+        if (x.size() > y.size())
+            return x.size() > z.size() ? 0 : 2;
+        return y.size() > z.size() ? 1 : 2;
+    }
+
     bool hit(const ray& r, interval ray_t) const {
         const point3& origin = r.origin();
         const vector3& direction = r.direction();
@@ -53,6 +60,38 @@ public:
         return true;
     }
 
+    /**
+     * @brief Test de la boîte pour toutes les voies d'un paquet.
+     * @param packet Les rayons, avec leur intervalle courant
+     * @param active Voies à tester
+     * @return Masque des voies actives qui traversent la boîte
+     */
+    uint32_t hit_packet(const ray_packet& packet, uint32_t active) const {
+        // Sans branche et sur toutes les voies (les voies libres sont neutres) : la
+        // boucle, de longueur fixe, est vectorisée
+        int32_t inside[ray_packet::max_size];
+        for (int i = 0; i < ray_packet::max_size; ++i) {
+            float tx0 = (x.min - packet.origin_x[i]) * packet.inv_direction_x[i];
+            float tx1 = (x.max - packet.origin_x[i]) * packet.inv_direction_x[i];
+            float ty0 = (y.min - packet.origin_y[i]) * packet.inv_direction_y[i];
+            float ty1 = (y.max - packet.origin_y[i]) * packet.inv_direction_y[i];
+            float tz0 = (z.min - packet.origin_z[i]) * packet.inv_direction_z[i];
+            float tz1 = (z.max - packet.origin_z[i]) * packet.inv_direction_z[i];
+
+            float t_enter = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)),
+                                     std::max(std::min(tz0, tz1), packet.t_min[i]));
+            float t_exit = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)),
+                                    std::min(std::max(tz0, tz1), packet.t_max[i]));
+            inside[i] = t_exit > t_enter;
+        }
+
+        uint32_t mask = 0;
+        for (int i = 0; i < ray_packet::max_size; ++i) {
+            mask |= static_cast<uint32_t>(inside[i]) << i;
+        }
+        return mask & active;
+    }
+
     aabb(const aabb& box0, const aabb& box1) {
         x = interval(box0.x, box1.x);
         y = interval(box0.y, box1.y);
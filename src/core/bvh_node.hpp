@@ -4,13 +4,25 @@
 #include "hittable.hpp"
 #include "hittable_list.hpp"
 #include "lib/lib.hpp"
+#include "lib/thread_pool.hpp"
 
 class bvh_node : public Hittable {
 public:
-    bvh_node(hittable_list list) : bvh_node(list.objects, 0, list.objects.size()) {}
-
-    bvh_node(std::vector<shared_ptr<Hittable>>& objects, size_t start, size_t end) {
-        int axis = random_int(0, 2);
+    /**
+     * @param list Objets à organiser
+     * @param pool Si fourni, les grands sous-arbres sont construits en parallèle
+     */
+    bvh_node(hittable_list list, thread_pool* pool = nullptr)
+        : bvh_node(list.objects, 0, list.objects.size(), pool) {}
+
+    bvh_node(std::vector<shared_ptr<Hittable>>& objects, size_t start, size_t end,
+             thread_pool* pool = nullptr) {
+        // Axe le plus long de la boîte englobante : construction déterministe
+        bbox = aabb();
+        for (size_t i = start; i < end; i++) {
+            bbox = aabb(bbox, objects[i]->bounding_box());
+        }
+        int axis = bbox.longest_axis();
 
         auto comparator = (axis == 0) ? box_x_compare : (axis == 1) ? box_y_compare : box_z_compare;
 
@@ -25,11 +37,17 @@ public:
             std::sort(std::begin(objects) + start, std::begin(objects) + end, comparator);
 
             auto mid = start + object_span / 2;
-            left = make_shared<bvh_node>(objects, start, mid);
-            right = make_shared<bvh_node>(objects, mid, end);
+            if (pool && object_span >= parallel_threshold) {
+                // Les deux moitiés sont disjointes : le sous-arbre gauche part dans le pool
+                task_group group(*pool);
+                group.run([&] { left = make_shared<bvh_node>(objects, start, mid, pool); });
+                right = make_shared<bvh_node>(objects, mid, end, pool);
+                group.wait();
+            } else {
+                left = make_shared<bvh_node>(objects, start, mid);
+                right = make_shared<bvh_node>(objects, mid, end);
+            }
         }
-
-        bbox = aabb(left->bounding_box(), right->bounding_box());
     }
 
     bool hit(const ray& r, interval ray_t, HitRecord& rec) const override {
@@ -44,6 +62,38 @@ public:
         return hit_left || hit_right;
     }
 
+    uint32_t hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const override {
+        uint32_t mask = bbox.hit_packet(packet, active);
+        if (mask == 0) {
+            return 0;
+        }
+        // Paquet trop divergent : le parcours commun ne rapporte plus rien
+        if (active_lanes(mask) < min_coherent_lanes) {
+            return Hittable::hit_packet(packet, mask, recs);
+        }
+        uint32_t hits = left->hit_packet(packet, mask, recs);
+        if (right != left) {
+            hits |= right->hit_packet(packet, mask, recs);
+        }
+        return hits;
+    }
+
+    bool occluded(const ray& r, interval ray_t) const override {
+        if (!bbox.hit(r, ray_t)) {
+            return false;
+        }
+        // N'importe quelle intersection suffit : le sous-arbre droit n'est visité que si
+        // le gauche n'a rien trouvé
+        return left->occluded(r, ray_t) || (right != left && right->occluded(r, ray_t));
+    }
+
+    void add_lights(light_list& lights) const override {
+        left->add_lights(lights);
+        if (right != left) {
+            right->add_lights(lights);
+        }
+    }
+
     aabb bounding_box() const override {
         return bbox;
     }
@@ -53,6 +103,12 @@ private:
     shared_ptr<Hittable> right;
     aabb bbox;
 
+    // En dessous, le coût d'une tâche dépasse le gain de la parallélisation
+    static constexpr size_t parallel_threshold = 4096;
+
+    // En dessous, les voies restantes d'un paquet continuent en rayons isolés
+    static constexpr int min_coherent_lanes = 2;
+
     static bool box_compare(const shared_ptr<Hittable> a, const shared_ptr<Hittable> b,
                             int axis_index) {
         auto a_axis_interval = a->bounding_box().get_axis_interval(axis_index);
@@ -1,82 +1,821 @@
 #include "camera.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
 #include <iostream>
-#include <thread>
+#include <limits>
 #include <vector>
 
 #include "lib/chrono_timer.hpp"
+#include "lib/thread_pool.hpp"
 #include "material/material.hpp"
 #include "maths/constants.hpp"
 
-void camera::render(const hittable_list& world, const std::string& output_filename) {
+namespace {
+
+// Entrelace les bits de x et y (code de Morton / courbe en Z)
+uint32_t morton_2d(uint32_t x, uint32_t y) {
+    auto spread = [](uint32_t v) {
+        v &= 0x0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+// Entrelace les 10 bits de poids faible de x, y et z
+uint32_t morton_3d(uint32_t x, uint32_t y, uint32_t z) {
+    auto spread = [](uint32_t v) {
+        v &= 0x000003ff;
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v << 8)) & 0x0300f00f;
+        v = (v | (v << 4)) & 0x030c30c3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1) | (spread(z) << 2);
+}
+
+uint64_t elapsed_nanoseconds(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count());
+}
+
+// Trie une file de rayons par clé de 30 bits : direction quantifiée sur 3 bits par axe
+// (les bits de poids fort donnent l'octant), puis code de Morton de l'origine sur 7 bits
+// par axe, relatif aux bornes des origines du lot. Tri par base (radix), 4 passes de 8 bits
+template <typename RayOf>
+void sort_by_ray_key(std::vector<uint32_t>& queue, RayOf ray_of) {
+    thread_local std::vector<uint32_t> keys;
+    thread_local std::vector<uint32_t> swap_keys;
+    thread_local std::vector<uint32_t> swap_queue;
+    size_t count = queue.size();
+    if (count < 2) {
+        return;
+    }
+
+    vector3 lo(infinity, infinity, infinity);
+    vector3 hi(-infinity, -infinity, -infinity);
+    for (uint32_t index : queue) {
+        const point3& o = ray_of(index).origin();
+        lo = vector3(std::min(lo.x(), o.x()), std::min(lo.y(), o.y()), std::min(lo.z(), o.z()));
+        hi = vector3(std::max(hi.x(), o.x()), std::max(hi.y(), o.y()), std::max(hi.z(), o.z()));
+    }
+    auto quantize = [](float value, float min, float max, uint32_t levels) {
+        float cell = (value - min) / std::max(max - min, 1e-20f) * levels;
+        return static_cast<uint32_t>(std::clamp(cell, 0.0f, static_cast<float>(levels - 1)));
+    };
+
+    keys.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        const ray& r = ray_of(queue[k]);
+        // Direction ramenée dans [-1, 1] par sa plus grande composante : pas de racine
+        const vector3& d = r.direction();
+        float largest = std::max(std::fabs(d.x()), std::max(std::fabs(d.y()), std::fabs(d.z())));
+        float inv = largest > 0.0f ? 1.0f / largest : 0.0f;
+        uint32_t direction = morton_3d(quantize(d.x() * inv, -1, 1, 8),
+                                       quantize(d.y() * inv, -1, 1, 8),
+                                       quantize(d.z() * inv, -1, 1, 8));
+        const point3& o = r.origin();
+        uint32_t origin = morton_3d(quantize(o.x(), lo.x(), hi.x(), 128),
+                                    quantize(o.y(), lo.y(), hi.y(), 128),
+                                    quantize(o.z(), lo.z(), hi.z(), 128));
+        keys[k] = (direction << 21) | origin;
+    }
+
+    swap_keys.resize(count);
+    swap_queue.resize(count);
+    for (int shift = 0; shift < 32; shift += 8) {
+        size_t offsets[257] = {};
+        for (uint32_t key : keys) {
+            offsets[((key >> shift) & 0xff) + 1]++;
+        }
+        for (int bucket = 0; bucket < 256; ++bucket) {
+            offsets[bucket + 1] += offsets[bucket];
+        }
+        for (size_t k = 0; k < count; ++k) {
+            size_t slot = offsets[(keys[k] >> shift) & 0xff]++;
+            swap_keys[slot] = keys[k];
+            swap_queue[slot] = queue[k];
+        }
+        keys.swap(swap_keys);
+        queue.swap(swap_queue);
+    }
+}
+
+// Graine d'un pixel pour l'échantillonneur : les ensembles de points des pixels diffèrent
+uint64_t pixel_seed(uint64_t seed, int x, int y) {
+    uint64_t h = seed ^ ((static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) |
+                         static_cast<uint32_t>(x));
+    h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdULL;
+    h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+    return h ^ (h >> 33);
+}
+
+// Graine d'un échantillon : ne dépend que du pixel et de son rang, pas du thread ni de la passe
+uint64_t sample_seed(uint64_t seed, int x, int y, uint32_t index) {
+    uint64_t h = seed ^ ((static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) |
+                         static_cast<uint32_t>(x));
+    h ^= (static_cast<uint64_t>(index) + 0x9e3779b97f4a7c15ULL) * 0xbf58476d1ce4e5b9ULL;
+    // Finalisation splitmix64
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+// Image intermédiaire écrite à côté puis renommée : un lecteur de `filename` (visionneuse,
+// script de suivi) ne voit jamais un PNG à moitié écrit
+void write_snapshot(const film& accumulation, const std::string& filename) {
+    std::string temporary = filename + ".tmp";
+    accumulation.resolve().WriteFile(temporary.c_str());
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Cannot replace snapshot: " << filename << std::endl;
+        std::remove(temporary.c_str());
+    }
+}
+
+}  // namespace
+
+std::vector<uint32_t> morton_tile_order(int tiles_x, int tiles_y) {
+    std::vector<uint32_t> tiles(std::max(0, tiles_x) * std::max(0, tiles_y));
+    for (uint32_t i = 0; i < tiles.size(); ++i) {
+        tiles[i] = i;
+    }
+    std::sort(tiles.begin(), tiles.end(), [tiles_x](uint32_t a, uint32_t b) {
+        return morton_2d(a % tiles_x, a / tiles_x) < morton_2d(b % tiles_x, b / tiles_x);
+    });
+    return tiles;
+}
+
+camera::render_stats camera::render(const hittable_list& world,
+                                    const std::string& output_filename) {
+    film accumulation(0, 0);
+    render_stats stats = render_film(world, accumulation, output_filename);
+
+    // Une partie écrit son film, fusionné plus tard avec les autres parties
+    if (part.count > 1) {
+        accumulation.save_checkpoint(output_filename, checkpoint_info());
+    } else {
+        write_image(accumulation, output_filename);
+    }
+    return stats;
+}
+
+film_checkpoint_info camera::checkpoint_info() const {
+    film_checkpoint_info info{seed, static_cast<uint32_t>(samples_per_pixel)};
+    if (part.count > 1) {
+        info.part_index = static_cast<uint32_t>(std::clamp(part.index, 0, part.count - 1));
+        info.part_count = static_cast<uint32_t>(part.count);
+        info.part_split = static_cast<uint32_t>(part.split);
+    }
+    return info;
+}
+
+camera::render_stats camera::render_film(const hittable_list& world, film& accumulation,
+                                         const std::string& output_filename) {
     initialize_camera();
 
-    Image canvas(image_width, image_height);
+    accumulation = film(image_width, image_height);
+
+    // Partie rendue : bornes entières réparties au plus juste entre les `count` parties
+    int part_count = std::max(1, part.count);
+    int part_index = std::clamp(part.index, 0, part_count - 1);
+    band_begin = 0;
+    band_end = image_height;
+    first_sample = 0;
+    part_samples = samples_per_pixel;
+    if (part_count > 1 && part.split == part_split::rows) {
+        band_begin = image_height * part_index / part_count;
+        band_end = image_height * (part_index + 1) / part_count;
+    } else if (part_count > 1) {
+        first_sample = static_cast<uint32_t>(samples_per_pixel * part_index / part_count);
+        part_samples = samples_per_pixel * (part_index + 1) / part_count -
+                       static_cast<int>(first_sample);
+    }
 
     Chrono render_timer;
     render_timer.start();
 
-    unsigned int num_threads = std::thread::hardware_concurrency();
-    if (num_threads == 0)
-        num_threads = 4;
+    thread_pool& workers = pool ? *pool : thread_pool::instance();
+    std::cout << "Rendering with " << workers.size() << " threads";
+    if (workers.node_count() > 1) {
+        std::cout << " on " << workers.node_count() << " NUMA nodes";
+    }
+    std::cout << "..." << std::endl;
+    if (part_count > 1) {
+        std::cout << "Part " << part_index + 1 << "/" << part_count << ": rows [" << band_begin
+                  << ", " << band_end << "), samples [" << first_sample << ", "
+                  << first_sample + part_samples << ")" << std::endl;
+    }
+
+    // Sources échantillonnées par l'éclairage direct
+    lights = light_list();
+    if (sample_lights) {
+        world.add_lights(lights);
+        if (!lights.empty()) {
+            std::cout << "Light sampling: " << lights.size() << " emissive primitives"
+                      << std::endl;
+        }
+    }
+
+    render_counters counters;
+    render_stats stats;
+
+    // Reprise : les échantillons déjà calculés sont repris tels quels. Hors de la bande
+    // d'une partie, les pixels restent vides : seule la bande compte (le film a sa ligne 0
+    // en haut, la bande compte les lignes depuis le bas)
+    auto band_min_samples = [&] {
+        return accumulation.min_sample_count(image_height - band_end, image_height - band_begin);
+    };
+    if (resume && !checkpoint_file.empty()) {
+        film_checkpoint_info info;
+        film_checkpoint_info current = checkpoint_info();
+        if (accumulation.load_checkpoint(checkpoint_file, info)) {
+            if (info.seed != seed) {
+                std::cerr << "Checkpoint seed mismatch, starting over: " << checkpoint_file
+                          << std::endl;
+                accumulation = film(image_width, image_height);
+            } else if (info.part_index != current.part_index ||
+                       info.part_count != current.part_count ||
+                       info.part_split != current.part_split) {
+                std::cerr << "Checkpoint part mismatch, starting over: " << checkpoint_file
+                          << std::endl;
+                accumulation = film(image_width, image_height);
+            } else {
+                std::cout << "Resuming from " << checkpoint_file << " ("
+                          << band_min_samples() << " spp)" << std::endl;
+                if (info.target_samples != static_cast<uint32_t>(samples_per_pixel)) {
+                    std::cout << "Checkpoint target was " << info.target_samples
+                              << " spp, now " << samples_per_pixel << " spp" << std::endl;
+                }
+            }
+        }
+    }
+
+    // Budget de temps : passes d'un échantillon par défaut, pour répartir les échantillons
+    // uniformément sur l'image quel que soit le moment où l'échéance tombe
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    int pass_size = pass_samples;
+    if (time_budget > 0) {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(time_budget));
+        pass_size = pass_size > 0 ? pass_size : 1;
+    }
 
-    std::cout << "Rendering with " << num_threads << " threads..." << std::endl;
+    // Mode progressif : passes de pass_size échantillons, image intermédiaire entre deux
+    int per_pass = std::max(1, pass_size > 0 ? std::min(pass_size, part_samples) : part_samples);
+    int pass_count = (part_samples + per_pass - 1) / per_pass;
+    const std::string& snapshot_file = snapshot_output.empty() ? output_filename : snapshot_output;
+    Chrono snapshot_timer;
+    snapshot_timer.start();
+    int passes_since_snapshot = 0;
+    auto checkpoint_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(0.0f, checkpoint_interval)));
+    auto next_checkpoint = std::chrono::steady_clock::now() + checkpoint_period;
 
-    std::vector<std::thread> threads;
-    std::atomic<int> next_line(0);
+    // Les passes déjà couvertes par un checkpoint sont sautées
+    int first_pass = static_cast<int>(band_min_samples()) / per_pass;
+    for (int pass = first_pass; pass < pass_count; ++pass) {
+        int target = std::min((pass + 1) * per_pass, part_samples);
 
-    auto render_lines = [&]() {
+        // Avec un checkpoint, la passe s'interrompt aussi à l'échéance du prochain
+        // checkpoint (même mécanisme que le budget de temps : tuiles et lignes déjà
+        // commencées terminées), puis reprend où elle en était : un rendu d'une seule
+        // passe est sauvegardé lui aussi. Une reprise qui n'a rien rendu désactive
+        // l'interruption pour la suite de la passe
+        bool interruptible = !checkpoint_file.empty();
         while (true) {
-            int y = next_line.fetch_add(1);
-            if (y >= image_height)
+            auto stop = interruptible ? std::min(deadline, next_checkpoint) : deadline;
+            uint64_t rays_before = counters.rays.load();
+            render_pass(world, accumulation, target, stop, counters);
+            auto now = std::chrono::steady_clock::now();
+            if (now < stop || now >= deadline) {
                 break;
+            }
+            accumulation.save_checkpoint(checkpoint_file, checkpoint_info());
+            next_checkpoint = now + checkpoint_period;
+            interruptible = counters.rays.load() != rays_before;
+        }
+        passes_since_snapshot++;
+        stats.passes++;
+
+        if (std::chrono::steady_clock::now() >= deadline) {
+            stats.deadline_reached = true;
+            break;
+        }
+
+        bool last_pass = pass + 1 == pass_count;
+        if (!checkpoint_file.empty() && !last_pass &&
+            std::chrono::steady_clock::now() >= next_checkpoint) {
+            accumulation.save_checkpoint(checkpoint_file, checkpoint_info());
+            next_checkpoint = std::chrono::steady_clock::now() + checkpoint_period;
+        }
+
+        // Sans critère de passes ni de temps, une image est écrite après chaque passe
+        bool by_passes = snapshot_every_passes > 0 || snapshot_interval <= 0;
+        bool snapshot_due =
+            (by_passes && passes_since_snapshot >= std::max(1, snapshot_every_passes)) ||
+            (snapshot_interval > 0 && snapshot_timer.stop() >= snapshot_interval);
+        if (pass_samples > 0 && !last_pass && snapshot_due && part_count == 1) {
+            write_snapshot(accumulation, snapshot_file);
+            render_timer.log("Pass " + std::to_string(pass + 1) + "/" +
+                             std::to_string(pass_count) + " (" + std::to_string(target) +
+                             " spp) -> " + snapshot_file);
+            snapshot_timer.start();
+            passes_since_snapshot = 0;
+        }
+    }
+
+    // Checkpoint final : permet de reprendre un rendu interrompu par l'échéance ou de
+    // prolonger un rendu terminé avec plus d'échantillons
+    if (!checkpoint_file.empty()) {
+        accumulation.save_checkpoint(checkpoint_file, checkpoint_info());
+    }
+
+    stats.seconds = render_timer.stop();
+    render_timer.log("Rendering finished");
+
+    // Statistiques des lignes rendues (celles de la bande pour une partie)
+    uint64_t total_samples = 0;
+    stats.min_samples = std::numeric_limits<uint32_t>::max();
+    for (int y = band_begin; y < band_end; ++y) {
+        for (int x = 0; x < image_width; ++x) {
+            uint32_t count = accumulation.get(x, image_height - 1 - y).count;
+            total_samples += count;
+            stats.min_samples = std::min(stats.min_samples, count);
+            stats.max_samples = std::max(stats.max_samples, count);
+        }
+    }
+    if (band_end <= band_begin) {
+        stats.min_samples = 0;  // Bande vide : plus de parties que de lignes
+    }
+    stats.mean_samples =
+        total_samples / std::max(1.0, static_cast<double>(image_width) * (band_end - band_begin));
+    stats.rays_per_sample =
+        static_cast<double>(counters.rays.load()) / std::max<uint64_t>(total_samples, 1);
+    stats.sort_seconds = counters.sort_nanoseconds.load() * 1e-9;
+    stats.extend_seconds = counters.extend_nanoseconds.load() * 1e-9;
+    stats.floor_reached = part_count > 1 ||
+                          stats.min_samples >= static_cast<uint32_t>(std::max(0, quality_floor));
+
+    std::cout << "Samples per pixel: " << stats.mean_samples << " (min " << stats.min_samples
+              << ", max " << stats.max_samples << "), rays per sample: " << stats.rays_per_sample
+              << std::endl;
+    if (wavefront_batch > 0) {
+        std::cout << "Wavefront: secondary rays " << (sort_rays ? "sorted in " : "unsorted")
+                  << (sort_rays ? std::to_string(stats.sort_seconds) + " s, " : ", ")
+                  << "traced in " << stats.extend_seconds << " s" << std::endl;
+    }
+    if (stats.deadline_reached) {
+        std::cout << "Time budget reached after " << stats.passes << " passes" << std::endl;
+    } else if (time_budget > 0) {
+        std::cout << "Sample cap of " << samples_per_pixel << " spp reached after "
+                  << stats.seconds << " s, before the time budget" << std::endl;
+    }
+    if (!stats.floor_reached) {
+        std::cerr << "Quality floor not reached: " << stats.min_samples << " < " << quality_floor
+                  << " samples per pixel" << std::endl;
+    }
+    return stats;
+}
+
+void camera::write_image(const film& accumulation, const std::string& output_filename) const {
+    if (denoise) {
+        Chrono denoise_timer;
+        denoise_timer.start();
+        denoise_film(accumulation, denoising, pool ? pool : &thread_pool::instance())
+            .WriteFile(output_filename.c_str());
+        denoise_timer.log("Denoising finished");
+    } else {
+        accumulation.resolve().WriteFile(output_filename.c_str());
+    }
+    if (!sample_count_output.empty()) {
+        accumulation.sample_count_image().WriteFile(sample_count_output.c_str());
+    }
+    if (!feature_output.empty()) {
+        accumulation.feature_image(film_feature::albedo)
+            .WriteFile((feature_output + "_albedo.png").c_str());
+        accumulation.feature_image(film_feature::normal)
+            .WriteFile((feature_output + "_normal.png").c_str());
+        accumulation.feature_image(film_feature::depth)
+            .WriteFile((feature_output + "_depth.png").c_str());
+    }
+}
+
+void camera::render_pass(const hittable_list& world, film& accumulation, int pass_target,
+                         std::chrono::steady_clock::time_point deadline,
+                         render_counters& counters) const {
+    thread_pool& workers = pool ? *pool : thread_pool::instance();
+
+    // Tuiles de la bande rendue, triées selon la courbe de Morton
+    int tile = std::max(1, tile_size);
+    int tiles_x = (image_width + tile - 1) / tile;
+    int tiles_y = (band_end - band_begin + tile - 1) / tile;
+    std::vector<uint32_t> tiles = morton_tile_order(tiles_x, tiles_y);
+
+    // Nombre de tuiles soumises mais pas encore commencées
+    std::atomic<size_t> waiting(tiles.size());
+    task_group group(workers);
+
+    // En fin d'image, il reste moins de tuiles que de workers : une tuile commencée est
+    // alors coupée en quatre pour que les workers inoccupés puissent en voler une part
+    std::function<void(int, int, int, int)> render_region = [&](int x0, int y0, int x1, int y1) {
+        size_t left = waiting.fetch_sub(1) - 1;
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return;  // Échéance dépassée : les tuiles restantes gardent leurs échantillons
+        }
+        int half_w = (x1 - x0) / 2;
+        int half_h = (y1 - y0) / 2;
+        if (left < workers.size() && half_w >= min_tile_size && half_h >= min_tile_size) {
+            int xm = x0 + half_w;
+            int ym = y0 + half_h;
+            waiting.fetch_add(4);
+            group.run([&, x0, y0, xm, ym] { render_region(x0, y0, xm, ym); });
+            group.run([&, xm, y0, x1, ym] { render_region(xm, y0, x1, ym); });
+            group.run([&, x0, ym, xm, y1] { render_region(x0, ym, xm, y1); });
+            group.run([&, xm, ym, x1, y1] { render_region(xm, ym, x1, y1); });
+            return;
+        }
+        render_tile(x0, y0, x1, y1, world, accumulation, pass_target, deadline, counters);
+    };
+
+    for (uint32_t tile_index : tiles) {
+        int x0 = (tile_index % tiles_x) * tile;
+        int y0 = band_begin + static_cast<int>(tile_index / tiles_x) * tile;
+        int x1 = std::min(x0 + tile, image_width);
+        int y1 = std::min(y0 + tile, band_end);
+        group.run([&, x0, y0, x1, y1] { render_region(x0, y0, x1, y1); });
+    }
+    group.wait();
+}
+
+void camera::render_tile(int x0, int y0, int x1, int y1, const hittable_list& world,
+                         film& accumulation, int pass_target,
+                         std::chrono::steady_clock::time_point deadline,
+                         render_counters& counters) const {
+    // Buffer local au worker, réutilisé d'une tuile à l'autre
+    thread_local std::vector<pixel_accumulator> tile_buffer;
+    int width = x1 - x0;
+    tile_buffer.resize(static_cast<size_t>(width) * (y1 - y0));
+    tile_counters tile;
+    int rendered_rows = 0;  // Lignes traitées avant l'échéance
+
+    if (wavefront_batch > 0) {
+        if (std::chrono::steady_clock::now() < deadline) {
+            for (int y = y0; y < y1; ++y) {
+                for (int x = x0; x < x1; ++x) {
+                    tile_buffer[(y - y0) * width + (x - x0)] =
+                        accumulation.get(x, image_height - 1 - y);
+                }
+            }
+            render_wavefront(x0, y0, x1, y1, tile_buffer.data(), world, pass_target, deadline,
+                             tile);
+            rendered_rows = y1 - y0;
+        }
+    } else {
+        int lanes = std::clamp(packet_size, 1, ray_packet::max_size);
+        for (int y = y0; y < y1 && std::chrono::steady_clock::now() < deadline; ++y) {
+            pixel_accumulator* row = &tile_buffer[(y - y0) * width];
+            for (int x = x0; x < x1; ++x) {
+                row[x - x0] = accumulation.get(x, image_height - 1 - y);
+            }
 
-            for (int x = 0; x < image_width; ++x) {
-                color pixel_color(0, 0, 0);
-                for (int sample = 0; sample < samples_per_pixel; sample++) {
-                    ray r = get_ray(x, y);
-                    pixel_color += ray_color(r, max_depth, world);
+            if (lanes > 1) {
+                for (int x = x0; x < x1; x += lanes) {
+                    render_packet(x, y, std::min(lanes, x1 - x), row + (x - x0), world, pass_target,
+                                  tile.rays);
+                }
+            } else {
+                for (int x = x0; x < x1; ++x) {
+                    // Les échantillons s'ajoutent un à un aux statistiques du pixel : les sommes
+                    // sont identiques quel que soit le découpage en passes
+                    pixel_accumulator& pixel = row[x - x0];
+                    while (pixel.count < static_cast<uint32_t>(pass_target) && !converged(pixel)) {
+                        start_pixel_sample(x, y, pixel.count);
+                        ray r = get_ray(x, y);
+                        sample_features features;
+                        color sample = ray_color(r, world, tile.rays, features);
+                        pixel.add(sample, features);
+                    }
                 }
+            }
+            rendered_rows++;
+        }
+    }
+
+    counters.rays.fetch_add(tile.rays);
+    counters.sort_nanoseconds.fetch_add(tile.sort_nanoseconds);
+    counters.extend_nanoseconds.fetch_add(tile.extend_nanoseconds);
 
-                color final_color = pixel_samples_scale * pixel_color;
-                canvas.SetPixel(x, image_height - 1 - y, final_color);
+    // Recopie groupée : le film n'est écrit qu'une fois par tuile
+    for (int y = y0; y < y0 + rendered_rows; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            accumulation.set(x, image_height - 1 - y, tile_buffer[(y - y0) * width + (x - x0)]);
+        }
+    }
+}
+
+void camera::render_packet(int x0, int y, int count, pixel_accumulator* pixels,
+                           const hittable_list& world, int pass_target,
+                           uint64_t& ray_count) const {
+    ray_packet packet;
+    HitRecord recs[ray_packet::max_size];
+    sample_state states[ray_packet::max_size];
+    int pixel_of_lane[ray_packet::max_size];
+
+    while (true) {
+        // Un échantillon par pixel non terminé : les rayons d'une ligne voisine sont cohérents
+        packet.size = 0;
+        for (int i = 0; i < count; ++i) {
+            pixel_accumulator& pixel = pixels[i];
+            if (pixel.count >= static_cast<uint32_t>(pass_target) || converged(pixel)) {
+                continue;
             }
+            start_pixel_sample(x0 + i, y, pixel.count);
+            ray r = get_ray(x0 + i, y);
+            int lane = packet.add(r, interval(0.00001f, infinity));
+            states[lane] = save_sample_state();  // La suite du chemin reprend ces tirages
+            pixel_of_lane[lane] = i;
+        }
+        if (packet.size == 0) {
+            return;
         }
+
+        ray_count += packet.size;
+        uint32_t hits = world.hit_packet(packet, packet.full_mask(), recs);
+
+        // Les rebonds sont incohérents : chaque voie poursuit son chemin seule
+        for (int lane = 0; lane < packet.size; ++lane) {
+            restore_sample_state(states[lane]);
+            sample_features features;
+            color sample = shade_path(packet.get_ray(lane), hits >> lane & 1u, recs[lane], world,
+                                      ray_count, features);
+            pixels[pixel_of_lane[lane]].add(sample, features);
+        }
+    }
+}
+
+// État d'un chemin en vol : son rayon courant, son throughput, la densité du rebond qui a
+// produit ce rayon (pondération MIS de l'émission) et ses tirages
+struct camera::wavefront_path {
+    ray r;
+    color throughput;
+    float scatter_pdf;
+    sample_state state;
+    int family = 0;  // Famille du matériau touché au rebond courant
+};
+
+void camera::render_wavefront(int x0, int y0, int x1, int y1, pixel_accumulator* pixels,
+                              const hittable_list& world, int pass_target,
+                              std::chrono::steady_clock::time_point deadline,
+                              tile_counters& counters) const {
+    thread_local std::vector<wavefront_path> paths;
+    thread_local std::vector<color> results;
+    thread_local std::vector<sample_features> features;
+    thread_local std::vector<int> path_pixels;  // Pixel de chaque chemin du tour
+    int width = x1 - x0;
+    int count = width * (y1 - y0);
+    size_t batch = static_cast<size_t>(wavefront_batch);
+    auto unfinished = [&](const pixel_accumulator& pixel) {
+        return pixel.count < static_cast<uint32_t>(pass_target) && !converged(pixel);
     };
 
-    for (unsigned int i = 0; i < num_threads; ++i) {
-        threads.emplace_back(render_lines);
+    while (std::chrono::steady_clock::now() < deadline) {
+        int pending = 0;
+        for (int i = 0; i < count; ++i) {
+            pending += unfinished(pixels[i]);
+        }
+        if (pending == 0) {
+            return;
+        }
+
+        // Sans critère adaptatif, plusieurs échantillons par pixel remplissent le lot
+        uint32_t per_pixel =
+            adaptive_sampling ? 1u : static_cast<uint32_t>(std::max<size_t>(1, batch / pending));
+
+        paths.clear();
+        path_pixels.clear();
+        for (int i = 0; i < count; ++i) {
+            const pixel_accumulator& pixel = pixels[i];
+            if (!unfinished(pixel)) {
+                continue;
+            }
+            int x = x0 + i % width;
+            int y = y0 + i / width;
+            uint32_t samples = std::min(per_pixel, pass_target - pixel.count);
+            for (uint32_t s = 0; s < samples; ++s) {
+                start_pixel_sample(x, y, pixel.count + s);
+                ray r = get_ray(x, y);
+                paths.push_back({r, color(1, 1, 1), 0.0f, save_sample_state()});
+                path_pixels.push_back(i);
+            }
+        }
+
+        results.assign(paths.size(), color(0, 0, 0));
+        features.resize(paths.size());
+        for (size_t first = 0; first < paths.size(); first += batch) {
+            trace_wavefront(paths.data() + first, std::min(batch, paths.size() - first),
+                            results.data() + first, features.data() + first, world, counters);
+        }
+
+        // Échantillons ajoutés dans leur ordre de génération : mêmes sommes qu'en série
+        for (size_t k = 0; k < results.size(); ++k) {
+            pixels[path_pixels[k]].add(results[k], features[k]);
+        }
     }
+}
 
-    for (auto& thread : threads) {
-        thread.join();
+void camera::trace_wavefront(wavefront_path* paths, size_t count, color* results,
+                             sample_features* features, const hittable_list& world,
+                             tile_counters& counters) const {
+    thread_local std::vector<uint32_t> queue;
+    thread_local std::vector<uint32_t> hits;
+    thread_local std::vector<HitRecord> recs;
+    thread_local std::vector<uint32_t> sorted;
+    interval ray_t(0.00001f, infinity);
+
+    queue.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        queue[i] = static_cast<uint32_t>(i);
     }
+    recs.resize(count);
+    sorted.resize(count);
 
-    canvas.WriteFile(output_filename.c_str());
-    render_timer.log("Rendering finished");
+    int lanes = std::clamp(packet_size, 1, ray_packet::max_size);
+    for (int bounce = 0; bounce < max_depth && !queue.empty(); ++bounce) {
+        // Extension : roulette puis intersection de tous les chemins vivants. Les rayons
+        // primaires, générés pixel par pixel, sont cohérents et partent en paquets
+        hits.clear();
+        if (bounce == 0 && lanes > 1) {
+            ray_packet packet;
+            HitRecord lane_recs[ray_packet::max_size];
+            for (size_t first = 0; first < queue.size(); first += lanes) {
+                packet.size = 0;
+                for (size_t k = first; k < std::min(queue.size(), first + lanes); ++k) {
+                    packet.add(paths[queue[k]].r, ray_t);
+                }
+                counters.rays += packet.size;
+                uint32_t mask = world.hit_packet(packet, packet.full_mask(), lane_recs);
+                for (int lane = 0; lane < packet.size; ++lane) {
+                    uint32_t index = queue[first + lane];
+                    features[index] =
+                        first_hit_features(paths[index].r, mask >> lane & 1u, lane_recs[lane]);
+                    if (mask >> lane & 1u) {
+                        recs[index] = std::move(lane_recs[lane]);
+                        hits.push_back(index);
+                    } else {
+                        results[index] += background_color(paths[index].r);
+                    }
+                }
+            }
+            queue.clear();
+        }
+
+        if (bounce > 0 && sort_rays) {
+            auto start = std::chrono::steady_clock::now();
+            sort_by_ray_key(queue, [paths](uint32_t index) -> const ray& {
+                return paths[index].r;
+            });
+            counters.sort_nanoseconds += elapsed_nanoseconds(start);
+        }
+
+        auto extend_start = std::chrono::steady_clock::now();
+        for (uint32_t index : queue) {
+            wavefront_path& path = paths[index];
+            if (bounce > 0) {
+                restore_sample_state(path.state);
+                bool alive = survives_roulette(bounce, path.throughput);
+                path.state = save_sample_state();
+                if (!alive) {
+                    continue;
+                }
+            }
+
+            counters.rays++;
+            bool hit = world.hit(path.r, ray_t, recs[index]);
+            if (bounce == 0) {
+                features[index] = first_hit_features(path.r, hit, recs[index]);
+            }
+            if (!hit) {
+                results[index] += path.throughput * background_color(path.r);
+                continue;
+            }
+            hits.push_back(index);
+        }
+        if (bounce > 0) {
+            counters.extend_nanoseconds += elapsed_nanoseconds(extend_start);
+        }
+
+        // Tri par dénombrement selon la famille du matériau touché, lue une seule fois
+        size_t starts[material_type_count + 1] = {};
+        for (uint32_t index : hits) {
+            paths[index].family = static_cast<int>(recs[index].mat->type());
+            starts[paths[index].family + 1]++;
+        }
+        for (int family = 0; family < material_type_count; ++family) {
+            starts[family + 1] += starts[family];
+        }
+        size_t fill[material_type_count];
+        std::copy(starts, starts + material_type_count, fill);
+        for (uint32_t index : hits) {
+            sorted[fill[paths[index].family]++] = index;
+        }
+
+        // Ombrage famille par famille : une boucle sans appel virtuel par famille connue,
+        // puis compaction des chemins diffusés dans la file du rebond suivant. L'émission
+        // et l'éclairage direct sont ajoutés dans le même ordre que dans `shade_path`
+        queue.clear();
+        auto shade = [&](int family, auto&& scatter) {
+            for (size_t k = starts[family]; k < starts[family + 1]; ++k) {
+                uint32_t index = sorted[k];
+                wavefront_path& path = paths[index];
+                const HitRecord& rec = recs[index];
+                restore_sample_state(path.state);
+                results[index] += path.throughput * emitted_light(path.r, rec, path.scatter_pdf);
+                if (bounce + 1 < max_depth) {
+                    results[index] +=
+                        path.throughput * sample_direct_light(rec, world, counters.rays);
+                }
+                ray scattered;
+                color attenuation;
+                bool alive = scatter(path.r, rec, attenuation, scattered);
+                path.state = save_sample_state();
+                if (alive) {
+                    path.throughput = path.throughput * attenuation;
+                    path.scatter_pdf = scatter_density(rec, scattered);
+                    path.r = scattered;
+                    queue.push_back(index);
+                }
+            }
+        };
+        shade(static_cast<int>(material_type::other),
+              [](const ray& r, const HitRecord& rec, color& attenuation, ray& scattered) {
+                  return rec.mat->scatter(r, rec, attenuation, scattered);
+              });
+        shade(static_cast<int>(material_type::lambertian),
+              [](const ray& r, const HitRecord& rec, color& attenuation, ray& scattered) {
+                  return static_cast<const lambertian&>(*rec.mat).lambertian::scatter(
+                      r, rec, attenuation, scattered);
+              });
+        shade(static_cast<int>(material_type::metal),
+              [](const ray& r, const HitRecord& rec, color& attenuation, ray& scattered) {
+                  return static_cast<const metal&>(*rec.mat).metal::scatter(r, rec, attenuation,
+                                                                            scattered);
+              });
+    }
+    // Les chemins encore en vol après max_depth rebonds restent noirs
+}
+
+void camera::start_pixel_sample(int x, int y, uint32_t index) const {
+    // Rang dans le pixel entier : une plage d'échantillons reprend les tirages du rendu complet
+    index += first_sample;
+    seed_random(sample_seed(seed, x, y, index));
+    start_sample(pixel_sampler.get(), pixel_seed(seed, x, y), index);
+}
+
+bool camera::converged(const pixel_accumulator& pixel) const {
+    if (!adaptive_sampling) {
+        return false;
+    }
+    return pixel.count >= static_cast<uint32_t>(samples_per_pixel) ||
+           (pixel.count >= static_cast<uint32_t>(min_samples) &&
+            pixel.relative_error() < adaptive_threshold);
 }
 
 void camera::initialize_camera() {
     image_height = static_cast<int>(image_width / aspect_ratio);
     image_height = (image_height < 1) ? 1 : image_height;
 
-    pixel_samples_scale = 1.0f / samples_per_pixel;
-
     float actual_aspect_ratio = image_width / static_cast<float>(image_height);
     auto theta = degrees_to_radians(vfov);
     auto h = std::tan(theta / 2);
 
     auto viewport_height = 2.0 * h * focal_length;
     viewport_width = actual_aspect_ratio * viewport_height;
-    horizontal = vector3(viewport_width, 0, 0);
-    vertical = vector3(0, viewport_height, 0);
+
+    // Repère de la caméra : w opposé à la visée, u vers la droite, v vers le haut. Sans
+    // visée explicite, (u, v, w) sont exactement les axes x, y, z
+    vector3 w = unit_vector(vector3(0, 0, 0) - view_direction);
+    vector3 u = cross(vector3(0, 1, 0), w);
+    u = u.near_zero() ? vector3(1, 0, 0) : unit_vector(u);  // Visée verticale
+    vector3 v = cross(w, u);
+    horizontal = viewport_width * u;
+    vertical = static_cast<float>(viewport_height) * v;
 
     pixel_step_u = horizontal / static_cast<float>(image_width);
     pixel_step_v = vertical / static_cast<float>(image_height);
 
-    viewport_top_left =
-        camera_origin - vector3(viewport_width / 2, viewport_height / 2, focal_length);
+    viewport_top_left = camera_origin - horizontal / 2 - vertical / 2 - focal_length * w;
     first_pixel_center = viewport_top_left + 0.5 * (pixel_step_u + pixel_step_v);
 }
 
@@ -90,21 +829,131 @@ color camera::background_color(const ray& r) const {
     return (1.0f - t) * color_from + t * color_to;
 }
 
-color camera::ray_color(const ray& r, int depth, const hittable_list& world) const {
+color camera::ray_color(const ray& r, const hittable_list& world, uint64_t& ray_count,
+                        sample_features& features) const {
     HitRecord rec;
+    ray_count++;
+    bool hit = world.hit(r, interval(0.00001f, infinity), rec);
+    return shade_path(r, hit, rec, world, ray_count, features);
+}
+
+sample_features camera::first_hit_features(const ray& r, bool hit, const HitRecord& rec) const {
+    sample_features features;
+    if (!hit) {
+        features.albedo = background_color(r);
+        return features;
+    }
+    features.albedo = rec.mat->base_color();
+    features.normal = rec.normal;
+    features.depth = rec.t * r.direction().length();
+    return features;
+}
+
+bool camera::survives_roulette(int bounce, color& throughput) const {
+    if (!russian_roulette || bounce < roulette_start_bounce) {
+        return true;
+    }
+    // Un chemin sombre est arrêté avec probabilité 1 - p, les survivants sont pondérés
+    // par 1 / p pour que l'estimateur reste sans biais. Aucun tirage quand p vaut 1 : le
+    // rayon primaire, déjà tracé, n'en consomme pas
+    float p = std::clamp(std::max(throughput.x(), std::max(throughput.y(), throughput.z())),
+                         0.05f, 1.0f);
+    if (p < 1.0f && random_float() >= p) {
+        return false;
+    }
+    throughput = throughput / p;
+    return true;
+}
+
+color camera::shade_path(const ray& r, bool hit, HitRecord& rec, const hittable_list& world,
+                         uint64_t& ray_count, sample_features& features) const {
+    features = first_hit_features(r, hit, rec);
     interval ray_t(0.00001f, infinity);
-    if (depth <= 0)
-        return color(0, 0, 0);
+    ray current = r;
+    color throughput(1, 1, 1);  // Produit des atténuations le long du chemin
+    color radiance(0, 0, 0);    // Lumière déjà collectée le long du chemin
+    float scatter_pdf = 0.0f;   // Densité du dernier rebond (0 : rayon primaire ou spéculaire)
+
+    for (int bounce = 0; bounce < max_depth; ++bounce) {
+        if (bounce > 0) {
+            if (!survives_roulette(bounce, throughput)) {
+                return radiance;
+            }
+
+            ray_count++;
+            hit = world.hit(current, ray_t, rec);
+        }
+
+        if (!hit) {
+            return radiance + throughput * background_color(current);
+        }
+
+        // Au dernier rebond, la source ne serait plus atteinte par le rayon diffusé :
+        // l'éclairage direct est omis pour couvrir les mêmes longueurs de chemin
+        radiance += throughput * emitted_light(current, rec, scatter_pdf);
+        if (bounce + 1 < max_depth) {
+            radiance += throughput * sample_direct_light(rec, world, ray_count);
+        }
 
-    if (world.hit(r, ray_t, rec)) {
         ray scattered;
         color attenuation;
-        if (rec.mat->scatter(r, rec, attenuation, scattered))
-            return attenuation * ray_color(scattered, depth - 1, world);
+        if (!rec.mat->scatter(current, rec, attenuation, scattered)) {
+            return radiance;
+        }
+        throughput = throughput * attenuation;
+        scatter_pdf = scatter_density(rec, scattered);
+        current = scattered;
+    }
+
+    // Chemin tronqué à max_depth rebonds : seule la lumière déjà collectée parvient
+    return radiance;
+}
+
+color camera::emitted_light(const ray& r, const HitRecord& rec, float scatter_pdf) const {
+    color emission = rec.mat->emitted();
+    // Une source que l'éclairage direct ne tire pas (plan) n'est atteinte que par rebond
+    if (scatter_pdf <= 0.0f || !rec.sampled_light || lights.empty() || emission.near_zero()) {
+        return emission;
+    }
+    float light_pdf = lights.pdf(r.origin(), rec.p, rec.normal);
+    return emission * power_heuristic(scatter_pdf, light_pdf);
+}
+
+color camera::sample_direct_light(const HitRecord& rec, const hittable_list& world,
+                                  uint64_t& ray_count) const {
+    if (lights.empty()) {
+        return color(0, 0, 0);
+    }
+    light_sample light = lights.sample(next_2d());
+
+    vector3 to_light = light.p - rec.p;
+    float distance = to_light.length();
+    vector3 direction = to_light / distance;
+    color value;
+    float scatter_pdf;
+    if (!rec.mat->evaluate(rec, direction, value, scatter_pdf)) {
+        return color(0, 0, 0);  // Matériau spéculaire, ou source sous la surface
+    }
+    float light_pdf = lights.pdf(rec.p, light.p, light.normal);
+    if (light_pdf <= 0.0f) {
+        return color(0, 0, 0);  // Source vue par la tranche
+    }
+
+    // Rayon d'ombre arrêté juste avant la source, qui ne doit pas s'occulter elle-même
+    ray_count++;
+    if (world.occluded(ray(rec.p, direction), interval(0.00001f, distance * 0.999f))) {
         return color(0, 0, 0);
     }
+    return value * light.emission * (power_heuristic(light_pdf, scatter_pdf) / light_pdf);
+}
 
-    return background_color(r);
+float camera::scatter_density(const HitRecord& rec, const ray& scattered) const {
+    if (lights.empty()) {
+        return 0.0f;  // Sans source échantillonnée, aucune pondération MIS à calculer
+    }
+    color value;
+    float pdf;
+    return rec.mat->evaluate(rec, scattered.direction(), value, pdf) ? pdf : 0.0f;
 }
 
 ray camera::get_ray(int i, int j) const {
@@ -120,5 +969,6 @@ ray camera::get_ray(int i, int j) const {
 }
 
 vector3 camera::sample_square() const {
-    return vector3(random_float() - 0.5f, random_float() - 0.5f, 0);
+    sample_2d offset = next_2d();
+    return vector3(offset.u - 0.5f, offset.v - 0.5f, 0);
 }
\ No newline at end of file
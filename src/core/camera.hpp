@@ -1,13 +1,49 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
 #include "core/hitrecord.hpp"
 #include "core/hittable.hpp"
 #include "core/hittable_list.hpp"
+#include "core/light.hpp"
 #include "core/ray.hpp"
+#include "image/denoiser.hpp"
+#include "image/film.hpp"
 #include "image/image.hpp"
+#include "lib/thread_pool.hpp"
 #include "maths/interval.hpp"
+#include "maths/sampler.hpp"
 #include "maths/vector3.hpp"
 
+/** @brief Découpage d'un rendu distribué : par plages d'échantillons ou bandes de lignes. */
+enum class part_split { samples, rows };
+
+/**
+ * @brief Partie `index` (à partir de 0) sur `count` d'un rendu.
+ *
+ * Les tirages ne dépendent que de (graine, pixel, rang de l'échantillon) : des parties
+ * rendues par des processus ou des machines différents se fusionnent en l'image complète.
+ */
+struct render_part {
+    int index = 0;
+    int count = 1;
+    part_split split = part_split::samples;
+
+    bool partial() const {
+        return count > 1;
+    }
+};
+
+/**
+ * @brief Ordre de rendu d'une grille de `tiles_x` x `tiles_y` tuiles : les indices
+ * `y * tiles_x + x` triés selon la courbe de Morton (en Z), de sorte que des tuiles
+ * consécutives restent voisines dans l'image.
+ */
+std::vector<uint32_t> morton_tile_order(int tiles_x, int tiles_y);
+
 /**
  * @brief Classe représentant la caméra du raytracer
  *
@@ -20,19 +56,165 @@ public:
     float aspect_ratio = 16.0f / 9.0f;
     int image_width = 1080;
     point3 camera_origin = point3(0, 0, 0);
+    vector3 view_direction = vector3(0, 0, -1);  // Axe de visée, l'image garde +y vers le haut
     float focal_length = 1.0f;
     float vfov = 90.0f;
     int samples_per_pixel = 10;
     int max_depth = 5;
+    bool russian_roulette = true;       // Arrêt probabiliste des chemins peu contributifs
+    int roulette_start_bounce = 3;      // Premier rebond soumis à la roulette russe
+    bool adaptive_sampling = false;     // samples_per_pixel devient un plafond par pixel
+    int min_samples = 16;               // Échantillons minimaux d'un pixel en mode adaptatif
+    float adaptive_threshold = 0.02f;   // Erreur relative visée en mode adaptatif
+    std::string sample_count_output;    // Image du nombre d'échantillons par pixel (optionnelle)
+    int pass_samples = 0;               // Échantillons par passe en mode progressif (0 : désactivé)
+    int snapshot_every_passes = 0;      // Image intermédiaire toutes les N passes (0 : ignoré)...
+    float snapshot_interval = 0.0f;     // ... ou toutes les N secondes (0 : ignoré)
+    std::string snapshot_output;        // Image intermédiaire, le fichier de sortie si vide
+    float time_budget = 0.0f;           // Durée maximale du rendu en secondes (0 : illimitée)
+    int quality_floor = 0;              // Échantillons par pixel attendus au minimum
+    uint64_t seed = 0;                  // Graine : même graine, même image
+    std::string checkpoint_file;        // Checkpoint du film (vide : désactivé)
+    float checkpoint_interval = 60.0f;  // Secondes minimales entre deux checkpoints
+    bool resume = false;                // Reprend depuis `checkpoint_file` s'il existe
+    int tile_size = 32;                 // Côté des tuiles de rendu, en pixels (16 à 64 conseillé)
+    int min_tile_size = 8;              // Côté minimal d'une tuile redécoupée en fin d'image
+    int packet_size = 8;                // Rayons primaires par paquet (4, 8, 16 ; 1 : isolés)
+    int wavefront_batch = 0;            // Chemins en vol du mode wavefront (0 : désactivé)
+    bool sort_rays = false;             // Mode wavefront : rayons secondaires triés avant tracé
+    bool sample_lights = true;          // Éclairage direct : rayons d'ombre vers les sources
+    bool denoise = false;               // Débruitage de l'image finale, guidé par les attributs
+    denoise_options denoising;          // Réglages du débruitage (force, nombre de passes)
+    std::string feature_output;         // Préfixe des images d'attributs (vide : aucune)
+    render_part part;                   // Partie à rendre, l'image entière par défaut
+    thread_pool* pool = nullptr;        // Pool de rendu, `thread_pool::instance()` si nullptr
+
+    // Échantillonneur du placement dans le pixel et des rebonds (nullptr : indépendant)
+    std::shared_ptr<const sampler> pixel_sampler;
+
+    /**
+     * @brief Bilan d'un rendu.
+     */
+    struct render_stats {
+        double seconds = 0.0;
+        int passes = 0;
+        double mean_samples = 0.0;  // Échantillons par pixel, en moyenne
+        uint32_t min_samples = 0;
+        uint32_t max_samples = 0;
+        double rays_per_sample = 0.0;
+        bool deadline_reached = false;  // Rendu interrompu par `time_budget`
+        bool floor_reached = true;      // Tous les pixels ont au moins `quality_floor` échantillons
+        double sort_seconds = 0.0;      // Mode wavefront : tri des rayons, cumulé sur les threads
+        double extend_seconds = 0.0;    // Mode wavefront : intersection des rayons secondaires
+    };
 
     /**
      * @brief Rend la scène complète
+     *
+     * L'image est découpée en tuiles carrées de `tile_size` pixels, soumises au pool de
+     * threads partagé dans l'ordre de Morton : les rayons successifs d'un thread restent
+     * dans une petite zone de la scène, et chaque tuile est accumulée dans un buffer
+     * local avant d'être recopiée dans l'image. Quand il reste moins de tuiles que de
+     * workers, les tuiles sont redécoupées en quatre (jusqu'à `min_tile_size`) pour
+     * que la fin de l'image ne repose pas sur un seul thread. Le buffer de chaque tuile
+     * est thread_local, alloué et touché en premier par le worker qui la rend (placement
+     * NUMA local) ; le film final est alloué par le thread appelant.
+     *
+     * En mode adaptatif, chaque pixel suit la moyenne et la variance de sa luminance :
+     * après `min_samples` échantillons, il s'arrête dès que l'erreur relative de sa
+     * moyenne passe sous `adaptive_threshold`, ou à `samples_per_pixel` au plus.
+     *
+     * En mode progressif (`pass_samples` > 0), l'image est rendue en passes de
+     * `pass_samples` échantillons accumulées dans un film flottant ; entre deux passes,
+     * l'image courante est écrite dans `snapshot_output` toutes les
+     * `snapshot_every_passes` passes ou `snapshot_interval` secondes (après chaque
+     * passe si aucun des deux n'est fixé). Elle est écrite à côté puis renommée : un
+     * lecteur du fichier ne voit jamais une image incomplète.
+     *
+     * Avec un `time_budget`, le rendu se fait en passes (d'un échantillon par défaut) et
+     * s'arrête proprement à l'échéance, au plus tard au début de la ligne suivante de
+     * chaque tuile. Le budget est une borne, pas une durée à remplir : `samples_per_pixel`
+     * reste le plafond, et un rendu qui l'atteint avant l'échéance s'arrête là. Chaque
+     * pixel est normalisé par son propre nombre d'échantillons ;
+     * `render_stats::floor_reached` indique si `quality_floor` a été atteint partout.
+     *
+     * Chaque échantillon tire ses nombres aléatoires d'un générateur réensemencé à
+     * partir de (`seed`, pixel, rang de l'échantillon) : l'image ne dépend ni du nombre
+     * de threads ni du découpage en passes. Avec `checkpoint_file`, le film est
+     * sauvegardé toutes les `checkpoint_interval` secondes, au besoin au milieu d'une
+     * passe (les tuiles commencées finissent leur ligne), et en fin de rendu ; avec
+     * `resume`, le rendu repart de ce fichier jusqu'à `samples_per_pixel` et donne la
+     * même image qu'un rendu ininterrompu. Le placement du rayon dans le pixel et les
+     * directions des rebonds diffus sont tirés de `pixel_sampler` (Sobol brouillé,
+     * stratifié ou indépendant), dimension par dimension.
+     *
+     * Avec `wavefront_batch` > 0, chaque tuile est rendue par un intégrateur wavefront :
+     * des lots de `wavefront_batch` chemins avancent ensemble, rebond par rebond, en
+     * étapes séparées (intersection de tous les chemins, tri par famille de matériau,
+     * ombrage de chaque famille dans sa propre boucle, compaction des chemins
+     * survivants). Un lot d'un millier de chemins (environ 100 octets chacun) tient
+     * dans le cache L2. L'image est identique à celle du rendu chemin par chemin.
+     * Avec `sort_rays`, les rayons secondaires d'un lot sont triés avant chaque
+     * intersection selon une clé (octant et direction quantifiée, puis code de Morton de
+     * l'origine) : les rayons qui traversent les mêmes régions du BVH sont tracés à la
+     * suite. Les durées de tri et d'intersection sont rapportées dans `render_stats`.
+     *
+     * Les primitives émissives (`diffuse_light`) de la scène forment la liste des
+     * sources. Avec `sample_lights`, chaque point diffus touché tire un point sur les
+     * sources et lance un rayon d'ombre (next-event estimation) ; la lumière atteinte
+     * par un rebond et celle du rayon d'ombre sont pondérées par l'heuristique de
+     * puissance (MIS), ce qui reste sans biais et convient aux petites comme aux
+     * grandes sources.
+     *
+     * Avec `denoise`, l'image écrite est débruitée par `denoise_film`, guidé par
+     * l'albédo, la normale et la profondeur du premier point touché de chaque échantillon.
+     *
+     * Avec une partie (`part.count` > 1), seule la bande de lignes ou la plage
+     * d'échantillons de `part.index` est rendue, et `output_filename` reçoit le film
+     * partiel (format checkpoint) au lieu d'une image : `write_image` produit l'image
+     * après fusion des parties par `film::merge_checkpoint`. Le plancher de qualité
+     * n'est vérifié qu'après la fusion.
+     *
      * @param world La liste des objets hittables dans la scène
      * @param output_filename Le nom du fichier de sortie
+     * @return Le bilan du rendu (échantillons obtenus, échéance, plancher de qualité)
+     */
+    render_stats render(const hittable_list& world,
+                        const std::string& output_filename = "scene.png");
+
+    /**
+     * @brief Rend la scène comme `render`, mais laisse l'écriture du résultat à l'appelant.
+     *
+     * `accumulation` est réinitialisé aux dimensions de l'image puis reçoit les échantillons ;
+     * `output_filename` ne sert qu'aux images intermédiaires du mode progressif. Permet
+     * d'écrire une image (`write_image`) pendant le rendu de la suivante.
      */
-    void render(const hittable_list& world, const std::string& output_filename = "scene.png");
+    render_stats render_film(const hittable_list& world, film& accumulation,
+                             const std::string& output_filename);
+
+    /**
+     * @brief Écrit l'image d'un film (débruitée avec `denoise`), ainsi que les images du
+     * nombre d'échantillons et des attributs si elles sont demandées
+     */
+    void write_image(const film& accumulation, const std::string& output_filename) const;
 
 private:
+    struct wavefront_path;
+
+    // Compteurs partagés par les tuiles d'un rendu
+    struct render_counters {
+        std::atomic<uint64_t> rays{0};
+        std::atomic<uint64_t> sort_nanoseconds{0};
+        std::atomic<uint64_t> extend_nanoseconds{0};
+    };
+
+    // Compteurs d'une tuile, ajoutés aux compteurs du rendu à la fin de la tuile
+    struct tile_counters {
+        uint64_t rays = 0;
+        uint64_t sort_nanoseconds = 0;
+        uint64_t extend_nanoseconds = 0;
+    };
+
     // Paramètres calculés
     int image_height;
     float viewport_width;
@@ -42,13 +224,22 @@ private:
     vector3 pixel_step_v;
     vector3 viewport_top_left;
     vector3 first_pixel_center;
-    float pixel_samples_scale;
+    light_list lights;  // Sources émissives de la scène rendue
+
+    // Partie rendue : lignes [band_begin, band_end) et échantillons à partir de first_sample
+    int band_begin = 0;
+    int band_end = 0;
+    uint32_t first_sample = 0;
+    int part_samples = 0;  // Échantillons par pixel de la partie
 
     /**
      * @brief Initialise les paramètres de la caméra
      */
     void initialize_camera();
 
+    /** @brief Graine, cible et partie enregistrées avec le film (checkpoint ou partie). */
+    film_checkpoint_info checkpoint_info() const;
+
     /**
      * @brief Calcule la couleur de fond avec un dégradé type espace
      * @param r Le rayon pour lequel calculer la couleur
@@ -58,12 +249,67 @@ private:
 
     /**
      * @brief Calcule la couleur d'un rayon en tenant compte des objets de la scène
-     * @param r Le rayon pour lequel calculer la couleur
+     *
+     * Intégrateur itératif : le chemin est suivi rebond par rebond en accumulant le
+     * produit des atténuations (throughput), sans récursion. La pile ne dépend donc
+     * pas de `max_depth`. À partir de `roulette_start_bounce`, la roulette russe
+     * arrête le chemin avec une probabilité qui croît quand le throughput diminue :
+     * `max_depth` peut être élevé sans que chaque chemin aille jusqu'au bout.
+     *
+     * @param r Le rayon primaire
      * @param world La liste des objets hittables dans la scène
-     * @param depth La profondeur maximale de récursion pour les rebonds de rayons
+     * @param ray_count Incrémenté à chaque rayon lancé
+     * @param features Reçoit les attributs du premier point touché
      * @return La couleur RGB correspondante
      */
-    color ray_color(const ray& r, int depth, const hittable_list& world) const;
+    color ray_color(const ray& r, const hittable_list& world, uint64_t& ray_count,
+                    sample_features& features) const;
+
+    /**
+     * @brief Roulette russe au rebond `bounce`
+     * @return false si le chemin est arrêté ; sinon `throughput` est repondéré
+     */
+    bool survives_roulette(int bounce, color& throughput) const;
+
+    /**
+     * @brief Suit un chemin dont la première intersection est déjà connue
+     *
+     * Partagé par `ray_color` et le tracé en paquets des rayons primaires.
+     *
+     * @param r Le rayon primaire
+     * @param hit true si le rayon primaire a touché un objet
+     * @param rec Intersection du rayon primaire, réutilisée pour les rebonds suivants
+     * @param features Reçoit les attributs du premier point touché
+     */
+    color shade_path(const ray& r, bool hit, HitRecord& rec, const hittable_list& world,
+                     uint64_t& ray_count, sample_features& features) const;
+
+    /**
+     * @brief Attributs du premier point touché par un rayon primaire, pour le débruitage :
+     * aucun rayon supplémentaire, l'intersection est celle du chemin
+     */
+    sample_features first_hit_features(const ray& r, bool hit, const HitRecord& rec) const;
+
+    /**
+     * @brief Lumière émise au point touché. Quand `r` vient d'un rebond diffus, la même
+     * source pouvait être atteinte par un rayon d'ombre : l'émission est alors pondérée
+     * par MIS, sauf pour une primitive absente de `lights` (`rec.sampled_light` faux)
+     * @param scatter_pdf Densité du rebond qui a produit `r` (0 : rayon primaire ou
+     * rebond spéculaire, poids 1)
+     */
+    color emitted_light(const ray& r, const HitRecord& rec, float scatter_pdf) const;
+
+    /**
+     * @brief Éclairage direct (next-event estimation) : un point tiré sur les sources, un
+     * rayon d'ombre, contribution pondérée par MIS. Nul pour un matériau spéculaire
+     */
+    color sample_direct_light(const HitRecord& rec, const hittable_list& world,
+                              uint64_t& ray_count) const;
+
+    /**
+     * @brief Densité avec laquelle le matériau a tiré `scattered` (0 : spéculaire)
+     */
+    float scatter_density(const HitRecord& rec, const ray& scattered) const;
 
     /**
      * @brief Génère un rayon pour un pixel donné avec un offset aléatoire
@@ -73,9 +319,67 @@ private:
      */
     ray get_ray(int i, int j) const;
 
+    /**
+     * @brief Ouvre l'échantillon `index` du pixel (x, y) : réensemence le générateur du
+     * thread et place l'échantillonneur sur ce pixel, à la dimension 0
+     */
+    void start_pixel_sample(int x, int y, uint32_t index) const;
+
     /**
      * @brief Génère un vecteur aléatoire dans le carré unitaire [-0.5, 0.5]
      * @return Un vecteur 3D avec composantes x,y aléatoires et z=0
      */
     vector3 sample_square() const;
+
+    /**
+     * @brief Rend une passe : complète chaque pixel jusqu'à `pass_target` échantillons
+     */
+    void render_pass(const hittable_list& world, film& accumulation, int pass_target,
+                     std::chrono::steady_clock::time_point deadline,
+                     render_counters& counters) const;
+
+    /**
+     * @brief Rend une tuile [x0, x1) x [y0, y1) dans un buffer local puis l'ajoute au film
+     * @param world La liste des objets hittables dans la scène
+     * @param accumulation Le film de destination
+     * @param pass_target Nombre d'échantillons par pixel visé à la fin de cette passe
+     * @param deadline Échéance au-delà de laquelle plus aucune ligne n'est commencée
+     * @param counters Compteurs du rendu (rayons lancés, durées du mode wavefront)
+     */
+    void render_tile(int x0, int y0, int x1, int y1, const hittable_list& world,
+                     film& accumulation, int pass_target,
+                     std::chrono::steady_clock::time_point deadline,
+                     render_counters& counters) const;
+
+    /**
+     * @brief Échantillonne une suite de pixels d'une ligne, un paquet de rayons primaires
+     * par tour : chaque pixel non terminé fournit une voie
+     * @param pixels Accumulateurs des pixels x0, x0 + 1, ... de la ligne y
+     */
+    void render_packet(int x0, int y, int count, pixel_accumulator* pixels,
+                       const hittable_list& world, int pass_target, uint64_t& ray_count) const;
+
+    /**
+     * @brief Rend une tuile en mode wavefront, par tours : chaque tour lance un lot
+     * d'échantillons sur les pixels non terminés de la tuile
+     * @param pixels Accumulateurs de la tuile, ligne par ligne
+     */
+    void render_wavefront(int x0, int y0, int x1, int y1, pixel_accumulator* pixels,
+                          const hittable_list& world, int pass_target,
+                          std::chrono::steady_clock::time_point deadline,
+                          tile_counters& counters) const;
+
+    /**
+     * @brief Fait avancer un lot de chemins jusqu'à leur fin, une étape à la fois
+     * @param results Couleur de chaque chemin, dans l'ordre du lot
+     * @param features Attributs du premier point touché par chaque chemin
+     */
+    void trace_wavefront(wavefront_path* paths, size_t count, color* results,
+                         sample_features* features, const hittable_list& world,
+                         tile_counters& counters) const;
+
+    /**
+     * @brief Indique si un pixel a assez d'échantillons (mode adaptatif uniquement)
+     */
+    bool converged(const pixel_accumulator& pixel) const;
 };
\ No newline at end of file
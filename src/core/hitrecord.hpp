@@ -11,6 +11,7 @@ public:
     shared_ptr<material> mat;
     float t;
     bool front_face;
+    bool sampled_light = false;  // Primitive ajoutée à la light_list si son matériau émet
 
     void set_face_normal(const ray& r, const vector3& outward_normal);
 };
@@ -0,0 +1,8 @@
+#include "hittable.hpp"
+
+#include "hitrecord.hpp"
+
+bool Hittable::occluded(const ray& r, interval ray_t) const {
+    HitRecord rec;
+    return hit(r, ray_t, rec);
+}
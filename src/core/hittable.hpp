@@ -1,14 +1,49 @@
 #pragma once
 
+#include <cstdint>
+
 #include "aabb.hpp"
+#include "ray_packet.hpp"
 
 class ray;
 struct HitRecord;
 class interval;
+class light_list;
 
 class Hittable {
 public:
     virtual ~Hittable() noexcept = default;
     virtual bool hit(const ray& r, interval ray_t, HitRecord& rec) const = 0;
     virtual aabb bounding_box() const = 0;
+
+    /**
+     * @brief Intersecte les voies actives d'un paquet de rayons.
+     *
+     * Pour chaque voie touchée, `recs[voie]` est rempli et `packet.t_max[voie]` réduit
+     * à la distance trouvée. L'implémentation par défaut trace chaque voie isolément ;
+     * les structures d'accélération la surchargent pour parcourir le paquet ensemble.
+     *
+     * @param packet Les rayons du paquet
+     * @param active Masque des voies à tracer
+     * @param recs Un enregistrement par voie du paquet
+     * @return Masque des voies pour lesquelles une intersection plus proche a été trouvée
+     */
+    virtual uint32_t hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const;
+
+    /**
+     * @brief Indique si le rayon touche un objet dans `ray_t` (rayons d'ombre, visibilité).
+     *
+     * S'arrête à la première intersection trouvée, quelle qu'elle soit, sans calculer
+     * de point, de normale ni de matériau. L'implémentation par défaut passe par `hit` ;
+     * les primitives et les structures d'accélération la surchargent.
+     */
+    virtual bool occluded(const ray& r, interval ray_t) const;
+
+    /**
+     * @brief Ajoute à `lights` les primitives émissives de l'objet, en espace monde.
+     *
+     * Rien par défaut ; les primitives à aire finie (sphères, triangles) et les objets
+     * qui en contiennent d'autres la surchargent.
+     */
+    virtual void add_lights(light_list& lights) const {}
 };
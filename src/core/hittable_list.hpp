@@ -39,6 +39,31 @@ public:
         return hit_anything;
     }
 
+    uint32_t hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const override {
+        uint32_t hits = 0;
+        for (const auto& object : objects) {
+            // Chaque objet réduit t_max des voies touchées : les suivants ne gardent que
+            // les intersections plus proches
+            hits |= object->hit_packet(packet, active, recs);
+        }
+        return hits;
+    }
+
+    bool occluded(const ray& r, interval ray_t) const override {
+        for (const auto& object : objects) {
+            if (object->occluded(r, ray_t)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void add_lights(light_list& lights) const override {
+        for (const auto& object : objects) {
+            object->add_lights(lights);
+        }
+    }
+
     aabb bounding_box() const override {
         return bbox;
     }
@@ -0,0 +1,66 @@
+#include "light.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "maths/constants.hpp"
+
+void light_list::add_sphere(const point3& center, float radius, const color& emission) {
+    add({center, vector3(0, 0, 0), vector3(0, 0, 0), radius, emission},
+        static_cast<float>(4.0 * pi) * radius * radius);
+}
+
+void light_list::add_triangle(const point3& v0, const point3& v1, const point3& v2,
+                              const color& emission) {
+    vector3 edge1 = v1 - v0;
+    vector3 edge2 = v2 - v0;
+    add({v0, edge1, edge2, 0.0f, emission}, 0.5f * cross(edge1, edge2).length());
+}
+
+void light_list::add(const shape& s, float shape_area) {
+    // Une source sans aire ne peut pas être tirée
+    if (!(shape_area > 0.0f)) {
+        return;
+    }
+    shapes.push_back(s);
+    area += shape_area;
+    cumulative_area.push_back(area);
+}
+
+light_sample light_list::sample(sample_2d sample) const {
+    float target = sample.u * area;
+    size_t index = std::upper_bound(cumulative_area.begin(), cumulative_area.end(), target) -
+                   cumulative_area.begin();
+    index = std::min(index, shapes.size() - 1);
+
+    float before = index > 0 ? cumulative_area[index - 1] : 0.0f;
+    float u = std::clamp((target - before) / (cumulative_area[index] - before), 0.0f,
+                         0x1.fffffep-1f);
+    const shape& s = shapes[index];
+
+    light_sample result;
+    result.emission = s.emission;
+    if (s.radius > 0.0f) {
+        float z = 1.0f - 2.0f * u;
+        float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        float phi = static_cast<float>(2.0 * pi) * sample.v;
+        result.normal = vector3(r * std::cos(phi), r * std::sin(phi), z);
+        result.p = s.origin + s.radius * result.normal;
+    } else {
+        // Coordonnées barycentriques uniformes sur le triangle
+        float su = std::sqrt(u);
+        result.p = s.origin + su * (1.0f - sample.v) * s.edge1 + su * sample.v * s.edge2;
+        result.normal = unit_vector(cross(s.edge1, s.edge2));
+    }
+    return result;
+}
+
+float light_list::pdf(const point3& origin, const point3& p, const vector3& normal) const {
+    vector3 to_light = p - origin;
+    float distance_squared = to_light.length_squared();
+    float cosine = std::fabs(dot(normal, to_light)) / std::sqrt(distance_squared);
+    if (area <= 0.0f || cosine <= 0.0f) {
+        return 0.0f;
+    }
+    return distance_squared / (cosine * area);
+}
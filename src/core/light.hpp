@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+#include "maths/sampler.hpp"
+#include "maths/vector3.hpp"
+
+/**
+ * @file light.hpp
+ * @brief Sources de lumière de la scène : primitives émissives échantillonnées par aire.
+ *
+ * La liste est remplie par `Hittable::add_lights` à partir des sphères et triangles
+ * dont le matériau émet. Un point est tiré uniformément sur l'aire totale des sources :
+ * sa densité ne dépend pas de la source touchée, ce qui permet de la retrouver pour
+ * n'importe quel point émissif atteint par un rebond (pondération MIS).
+ */
+
+/** @brief Point tiré sur une source. */
+struct light_sample {
+    point3 p;
+    vector3 normal;
+    color emission;
+};
+
+class light_list {
+public:
+    void add_sphere(const point3& center, float radius, const color& emission);
+    void add_triangle(const point3& v0, const point3& v1, const point3& v2,
+                      const color& emission);
+
+    bool empty() const {
+        return shapes.empty();
+    }
+    size_t size() const {
+        return shapes.size();
+    }
+    float total_area() const {
+        return area;
+    }
+
+    /**
+     * @brief Tire un point uniformément sur l'aire totale des sources.
+     *
+     * `sample.u` choisit la source, puis est réutilisé (remis à l'échelle) avec
+     * `sample.v` pour placer le point sur celle-ci : un seul point 2D par tirage.
+     */
+    light_sample sample(sample_2d sample) const;
+
+    /**
+     * @brief Densité, en angle solide vu depuis `origin`, de tirer le point `p` de normale
+     * `normal` (sources émettant des deux côtés)
+     */
+    float pdf(const point3& origin, const point3& p, const vector3& normal) const;
+
+private:
+    struct shape {
+        point3 origin;   // Centre de la sphère ou premier sommet du triangle
+        vector3 edge1;   // Arêtes du triangle depuis `origin`
+        vector3 edge2;
+        float radius;    // 0 pour un triangle
+        color emission;
+    };
+
+    std::vector<shape> shapes;
+    std::vector<float> cumulative_area;  // Aire des sources 0 à i incluses
+    float area = 0.0f;
+
+    void add(const shape& s, float shape_area);
+};
+
+/** @brief Heuristique de puissance (Veach) : poids de la stratégie de densité `pdf`. */
+inline float power_heuristic(float pdf, float other_pdf) {
+    float a = pdf * pdf;
+    float b = other_pdf * other_pdf;
+    return a + b > 0.0f ? a / (a + b) : 0.0f;
+}
@@ -0,0 +1,16 @@
+#include "ray_packet.hpp"
+
+#include "hitrecord.hpp"
+#include "hittable.hpp"
+
+uint32_t Hittable::hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const {
+    uint32_t hits = 0;
+    for (int lane = 0; lane < packet.size; ++lane) {
+        if ((active >> lane & 1u) &&
+            hit(packet.get_ray(lane), packet.get_interval(lane), recs[lane])) {
+            packet.t_max[lane] = recs[lane].t;
+            hits |= 1u << lane;
+        }
+    }
+    return hits;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/ray.hpp"
+#include "maths/interval.hpp"
+
+/**
+ * @file ray_packet.hpp
+ * @brief Paquet de rayons cohérents tracés ensemble dans le BVH.
+ *
+ * Les rayons sont stockés en SoA (un tableau par composante) : les tests de boîtes
+ * englobantes sur toutes les voies du paquet sont de simples boucles sans branche,
+ * vectorisées par le compilateur (SSE/AVX/NEON selon la cible).
+ */
+
+/**
+ * @brief Jusqu'à 16 rayons, avec leur intervalle [t_min, t_max] courant.
+ *
+ * `t_max` d'une voie est réduit à chaque intersection trouvée, comme `closest_so_far`
+ * dans le parcours d'un rayon isolé. Les voies actives sont désignées par un masque de
+ * bits (bit i : voie i).
+ */
+struct ray_packet {
+    static constexpr int max_size = 16;
+
+    int size = 0;
+    float origin_x[max_size] = {};
+    float origin_y[max_size] = {};
+    float origin_z[max_size] = {};
+    float direction_x[max_size] = {};
+    float direction_y[max_size] = {};
+    float direction_z[max_size] = {};
+    float inv_direction_x[max_size] = {};
+    float inv_direction_y[max_size] = {};
+    float inv_direction_z[max_size] = {};
+    float t_min[max_size] = {};
+    float t_max[max_size] = {};
+
+    /** @brief Ajoute un rayon, renvoie l'indice de sa voie. */
+    int add(const ray& r, interval ray_t) {
+        int lane = size++;
+        origin_x[lane] = r.origin().x();
+        origin_y[lane] = r.origin().y();
+        origin_z[lane] = r.origin().z();
+        direction_x[lane] = r.direction().x();
+        direction_y[lane] = r.direction().y();
+        direction_z[lane] = r.direction().z();
+        inv_direction_x[lane] = 1.0f / direction_x[lane];
+        inv_direction_y[lane] = 1.0f / direction_y[lane];
+        inv_direction_z[lane] = 1.0f / direction_z[lane];
+        t_min[lane] = ray_t.min;
+        t_max[lane] = ray_t.max;
+        return lane;
+    }
+
+    ray get_ray(int lane) const {
+        return ray(point3(origin_x[lane], origin_y[lane], origin_z[lane]),
+                   vector3(direction_x[lane], direction_y[lane], direction_z[lane]));
+    }
+
+    interval get_interval(int lane) const {
+        return interval(t_min[lane], t_max[lane]);
+    }
+
+    /** @brief Masque de toutes les voies du paquet. */
+    uint32_t full_mask() const {
+        return size >= 32 ? 0xffffffffu : (1u << size) - 1u;
+    }
+};
+
+/** @brief Nombre de voies actives d'un masque. */
+inline int active_lanes(uint32_t mask) {
+    int count = 0;
+    for (; mask; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
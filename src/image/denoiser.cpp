@@ -0,0 +1,272 @@
+#include "denoiser.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "lib/thread_pool.hpp"
+
+namespace {
+
+// Noyau B3-spline à 5 coefficients, appliqué séparément en x et en y
+constexpr float kernel[5] = {1.0f / 16, 1.0f / 4, 3.0f / 8, 1.0f / 4, 1.0f / 16};
+
+// Approximation de exp(-x) pour x >= 0 : (1 - x / 256)^256. Huit produits, sans appel de
+// fonction ni branche, la boucle des poids est ainsi vectorisée ; l'erreur n'est sensible
+// que pour des poids déjà négligeables
+inline float negative_exp(float x) {
+    float t = 1.0f - x * (1.0f / 256.0f);
+    t = 0.5f * (t + std::fabs(t));  // max(t, 0) sans comparaison, que GCC changerait en branche
+    for (int i = 0; i < 8; ++i) {
+        t *= t;
+    }
+    return t;
+}
+
+// Image en plans séparés (structure de tableaux) : chaque grandeur est contiguë par ligne
+struct planes {
+    std::vector<float> r, g, b, variance;
+
+    explicit planes(size_t size) : r(size), g(size), b(size), variance(size) {}
+};
+
+struct guides {
+    std::vector<float> albedo_r, albedo_g, albedo_b;
+    std::vector<float> normal_x, normal_y, normal_z;
+    std::vector<float> depth;
+    std::vector<float> depth_slope;  // Plus grande variation de profondeur vers un voisin
+
+    explicit guides(size_t size)
+        : albedo_r(size), albedo_g(size), albedo_b(size), normal_x(size), normal_y(size),
+          normal_z(size), depth(size), depth_slope(size) {}
+};
+
+class atrous_filter {
+public:
+    atrous_filter(int width, int height, const guides& features, const denoise_options& options)
+        : width(width), height(height), features(features), options(options) {}
+
+    // Lignes [y0, y1) de la passe de pas `step` : `in` vers `out`. `luminance_scale`
+    // contient, par pixel, l'inverse de l'écart de luminance toléré
+    void filter_rows(int y0, int y1, int step, const planes& in, const std::vector<float>& luma,
+                     const std::vector<float>& luminance_scale, planes& out) const;
+
+private:
+    int width;
+    int height;
+    const guides& features;
+    const denoise_options& options;
+};
+
+void atrous_filter::filter_rows(int y0, int y1, int step, const planes& in,
+                                const std::vector<float>& luma,
+                                const std::vector<float>& luminance_scale, planes& out) const {
+    // Sommes d'un segment de ligne dans des tableaux locaux : sans alias possible avec les
+    // plans lus, les boucles sur les pixels sont vectorisées sans tests à l'exécution
+    constexpr int chunk = 64;
+    float sum_w[chunk], sum_r[chunk], sum_g[chunk], sum_b[chunk], sum_v[chunk];
+    float weight[chunk];
+    float normal_weight = options.normal_weight;
+    float albedo_weight = options.albedo_weight;
+    float depth_tolerance = options.depth_tolerance;
+
+    for (int y = y0; y < y1; ++y) {
+        for (int cx = 0; cx < width; cx += chunk) {
+            int count = std::min(chunk, width - cx);
+            std::fill(sum_w, sum_w + chunk, 0.0f);
+            std::fill(sum_r, sum_r + chunk, 0.0f);
+            std::fill(sum_g, sum_g + chunk, 0.0f);
+            std::fill(sum_b, sum_b + chunk, 0.0f);
+            std::fill(sum_v, sum_v + chunk, 0.0f);
+            size_t row = static_cast<size_t>(y) * width + cx;
+
+            for (int ky = -2; ky <= 2; ++ky) {
+                int yq = y + ky * step;
+                if (yq < 0 || yq >= height) {
+                    continue;
+                }
+                for (int kx = -2; kx <= 2; ++kx) {
+                    // Pixels i du segment dont le voisin cx + i + dx est dans l'image
+                    int dx = kx * step;
+                    int i0 = std::max(0, -dx - cx);
+                    int i1 = std::min(count, width - dx - cx);
+                    if (i0 >= i1) {
+                        continue;
+                    }
+                    float h = kernel[ky + 2] * kernel[kx + 2];
+                    float distance = step * std::sqrt(static_cast<float>(kx * kx + ky * ky));
+
+                    // Segments du pixel (p) et de la ligne du voisin (q), lue en i + dx
+                    size_t shifted = static_cast<size_t>(yq) * width + cx;
+                    const float* lp = luma.data() + row;
+                    const float* lq = luma.data() + shifted;
+                    const float* scale = luminance_scale.data() + row;
+                    const float* nxp = features.normal_x.data() + row;
+                    const float* nyp = features.normal_y.data() + row;
+                    const float* nzp = features.normal_z.data() + row;
+                    const float* nxq = features.normal_x.data() + shifted;
+                    const float* nyq = features.normal_y.data() + shifted;
+                    const float* nzq = features.normal_z.data() + shifted;
+                    const float* arp = features.albedo_r.data() + row;
+                    const float* agp = features.albedo_g.data() + row;
+                    const float* abp = features.albedo_b.data() + row;
+                    const float* arq = features.albedo_r.data() + shifted;
+                    const float* agq = features.albedo_g.data() + shifted;
+                    const float* abq = features.albedo_b.data() + shifted;
+                    const float* zp = features.depth.data() + row;
+                    const float* zq = features.depth.data() + shifted;
+                    const float* slope = features.depth_slope.data() + row;
+
+                    // Un seul exp pour les quatre critères
+                    for (int i = i0; i < i1; ++i) {
+                        float d_luma = std::fabs(lp[i] - lq[i + dx]) * scale[i];
+                        float nx = nxp[i] - nxq[i + dx];
+                        float ny = nyp[i] - nyq[i + dx];
+                        float nz = nzp[i] - nzq[i + dx];
+                        float ar = arp[i] - arq[i + dx];
+                        float ag = agp[i] - agq[i + dx];
+                        float ab = abp[i] - abq[i + dx];
+                        // La pente locale est à l'échelle d'un pixel : tolérance proportionnelle
+                        // à la distance, plus 1 % de la profondeur pour les surfaces courbes
+                        float allowed =
+                            depth_tolerance * distance * slope[i] + 0.01f * zp[i] + 1e-6f;
+                        float d_depth = std::fabs(zp[i] - zq[i + dx]) / allowed;
+                        float penalty = d_luma + normal_weight * (nx * nx + ny * ny + nz * nz) +
+                                        albedo_weight * (ar * ar + ag * ag + ab * ab) + d_depth;
+                        weight[i] = h * negative_exp(penalty);
+                    }
+
+                    const float* rq = in.r.data() + shifted;
+                    const float* gq = in.g.data() + shifted;
+                    const float* bq = in.b.data() + shifted;
+                    const float* vq = in.variance.data() + shifted;
+                    for (int i = i0; i < i1; ++i) {
+                        float w = weight[i];
+                        sum_w[i] += w;
+                        sum_r[i] += w * rq[i + dx];
+                        sum_g[i] += w * gq[i + dx];
+                        sum_b[i] += w * bq[i + dx];
+                        sum_v[i] += w * w * vq[i + dx];
+                    }
+                }
+            }
+
+            // Le pixel central a toujours un poids non nul : sum_w > 0
+            for (int i = 0; i < count; ++i) {
+                float inv = 1.0f / sum_w[i];
+                out.r[row + i] = sum_r[i] * inv;
+                out.g[row + i] = sum_g[i] * inv;
+                out.b[row + i] = sum_b[i] * inv;
+                out.variance[row + i] = sum_v[i] * inv * inv;
+            }
+        }
+    }
+}
+
+// Inverse de l'écart de luminance toléré : 4 écarts-types du bruit par unité de force,
+// estimés sur la variance floutée en 3 x 3 (la variance d'un pixel est elle-même bruitée)
+void luminance_scales(int width, int y0, int y1, int height, const planes& in,
+                      float strength, std::vector<float>& luma, std::vector<float>& scale) {
+    static constexpr float blur[3] = {0.25f, 0.5f, 0.25f};
+    for (int y = y0; y < y1; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float sum = 0.0f;
+            float total = 0.0f;
+            for (int ky = -1; ky <= 1; ++ky) {
+                int yq = std::clamp(y + ky, 0, height - 1);
+                for (int kx = -1; kx <= 1; ++kx) {
+                    int xq = std::clamp(x + kx, 0, width - 1);
+                    float w = blur[ky + 1] * blur[kx + 1];
+                    sum += w * in.variance[static_cast<size_t>(yq) * width + xq];
+                    total += w;
+                }
+            }
+            size_t p = static_cast<size_t>(y) * width + x;
+            scale[p] = 1.0f / (4.0f * strength * std::sqrt(std::max(0.0f, sum / total)) + 1e-4f);
+            luma[p] = 0.2126f * in.r[p] + 0.7152f * in.g[p] + 0.0722f * in.b[p];
+        }
+    }
+}
+
+}  // namespace
+
+Image denoise_film(const film& accumulation, const denoise_options& options, thread_pool* pool) {
+    int width = static_cast<int>(accumulation.get_width());
+    int height = static_cast<int>(accumulation.get_height());
+    if (options.strength <= 0.0f || options.iterations <= 0 || width == 0 || height == 0) {
+        return accumulation.resolve();
+    }
+
+    size_t size = static_cast<size_t>(width) * height;
+    planes current(size);
+    planes next(size);
+    guides features(size);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t p = static_cast<size_t>(y) * width + x;
+            const pixel_accumulator& pixel = accumulation.get(x, y);
+            color mean = pixel.mean();
+            sample_features f = pixel.mean_features();
+            current.r[p] = mean.x();
+            current.g[p] = mean.y();
+            current.b[p] = mean.z();
+            current.variance[p] = pixel.mean_variance();
+            features.albedo_r[p] = f.albedo.x();
+            features.albedo_g[p] = f.albedo.y();
+            features.albedo_b[p] = f.albedo.z();
+            features.normal_x[p] = f.normal.x();
+            features.normal_y[p] = f.normal.y();
+            features.normal_z[p] = f.normal.z();
+            features.depth[p] = f.depth;
+        }
+    }
+
+    // Pente de profondeur : différences centrées, la plus forte des deux directions
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            auto depth_at = [&](int xq, int yq) {
+                return features.depth[static_cast<size_t>(std::clamp(yq, 0, height - 1)) * width +
+                                      std::clamp(xq, 0, width - 1)];
+            };
+            float slope_x = 0.5f * std::fabs(depth_at(x + 1, y) - depth_at(x - 1, y));
+            float slope_y = 0.5f * std::fabs(depth_at(x, y + 1) - depth_at(x, y - 1));
+            features.depth_slope[static_cast<size_t>(y) * width + x] = std::max(slope_x, slope_y);
+        }
+    }
+
+    thread_pool& workers = pool ? *pool : thread_pool::instance();
+    atrous_filter filter(width, height, features, options);
+    std::vector<float> luma(size);
+    std::vector<float> scale(size);
+
+    // Bandes de lignes : plusieurs par thread pour équilibrer la charge
+    int band = std::max(1, height / static_cast<int>(4 * std::max<size_t>(1, workers.size())));
+    auto for_each_band = [&](auto&& work) {
+        task_group group(workers);
+        for (int y0 = 0; y0 < height; y0 += band) {
+            int y1 = std::min(height, y0 + band);
+            group.run([&work, y0, y1] { work(y0, y1); });
+        }
+        group.wait();
+    };
+
+    for (int i = 0; i < options.iterations; ++i) {
+        int step = 1 << i;
+        for_each_band([&](int y0, int y1) {
+            luminance_scales(width, y0, y1, height, current, options.strength, luma, scale);
+        });
+        for_each_band([&](int y0, int y1) {
+            filter.filter_rows(y0, y1, step, current, luma, scale, next);
+        });
+        std::swap(current, next);
+    }
+
+    Image image(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t p = static_cast<size_t>(y) * width + x;
+            image.SetPixel(x, y, color(current.r[p], current.g[p], current.b[p]));
+        }
+    }
+    return image;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "film.hpp"
+#include "image.hpp"
+
+class thread_pool;
+
+/**
+ * @file denoiser.hpp
+ * @brief Débruitage du film : filtre en ondelettes « à trous » guidé par les attributs.
+ *
+ * Chaque passe moyenne un pixel avec 5 x 5 voisins espacés de 2^i pixels (noyau B3-spline),
+ * pondérés par leur ressemblance : luminance proche au regard du bruit estimé du pixel,
+ * mêmes normale, albédo et profondeur au premier point touché. Le flou s'étend ainsi
+ * jusqu'à 2^(passes + 1) pixels sans franchir les arêtes ni les changements de matériau
+ * (Dammertz et al., "Edge-Avoiding À-Trous Wavelet Transform", 2010 ; Schied et al.,
+ * "Spatiotemporal Variance-Guided Filtering", 2017).
+ *
+ * Le bruit d'un pixel est la variance de sa moyenne, tirée des moments de luminance du
+ * film ; elle est propagée d'une passe à l'autre. À force 1, un écart de luminance de
+ * 4 écarts-types divise le poids d'un voisin par e ; un pixel sans bruit estimé n'est
+ * mélangé qu'avec des voisins de même luminance.
+ */
+
+/** @brief Réglages du débruitage. */
+struct denoise_options {
+    float strength = 1.0f;        // Écart de luminance toléré, 4 écarts-types par unité
+    int iterations = 5;           // Passes ; la passe i compare des pixels distants de 2^i
+    float normal_weight = 64.0f;  // Pénalité par unité d'écart carré entre normales
+    float albedo_weight = 100.0f; // Pénalité par unité d'écart carré entre albédos
+    float depth_tolerance = 1.0f; // Écart de profondeur toléré, en pentes locales
+};
+
+/**
+ * @brief Image débruitée d'un film dont les échantillons portent leurs attributs.
+ * @param pool Pool réparti sur des bandes de lignes, `thread_pool::instance()` si nullptr
+ */
+Image denoise_film(const film& accumulation, const denoise_options& options,
+                   thread_pool* pool = nullptr);
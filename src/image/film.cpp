@@ -0,0 +1,293 @@
+#include "film.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+namespace {
+
+constexpr char checkpoint_magic[8] = {'R', 'A', 'Y', 'B', 'C', 'K', 'P', 'T'};
+// 2 : attributs du premier point touché ; 3 : partie d'un rendu distribué
+constexpr uint32_t checkpoint_version = 3;
+
+struct checkpoint_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t target_samples;
+    uint32_t part_index;
+    uint32_t part_count;
+    uint32_t part_split;
+    uint32_t reserved;
+    uint64_t seed;
+    uint64_t checksum;  // FNV-1a des accumulateurs
+};
+
+static_assert(std::is_trivially_copyable<pixel_accumulator>::value,
+              "les accumulateurs sont écrits tels quels");
+
+uint64_t fnv1a(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Lit et valide l'en-tête d'un checkpoint
+bool read_header(std::ifstream& in, const std::string& filename, checkpoint_header& header) {
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, checkpoint_magic, sizeof(checkpoint_magic)) != 0 ||
+        header.version != checkpoint_version) {
+        std::cerr << "Invalid checkpoint: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+film_checkpoint_info checkpoint_info(const checkpoint_header& header) {
+    return {header.seed, header.target_samples, header.part_index, header.part_count,
+            header.part_split};
+}
+
+float luminance(const color& c) {
+    return 0.2126f * c.x() + 0.7152f * c.y() + 0.0722f * c.z();
+}
+
+}  // namespace
+
+void pixel_accumulator::add(const color& sample) {
+    double l = luminance(sample);
+    sum += sample;
+    luminance_sum += l;
+    luminance_sq_sum += l * l;
+    count++;
+}
+
+void pixel_accumulator::add(const color& sample, const sample_features& features) {
+    add(sample);
+    albedo_sum += features.albedo;
+    normal_sum += features.normal;
+    depth_sum += features.depth;
+}
+
+void pixel_accumulator::merge(const pixel_accumulator& other) {
+    sum += other.sum;
+    luminance_sum += other.luminance_sum;
+    luminance_sq_sum += other.luminance_sq_sum;
+    count += other.count;
+    albedo_sum += other.albedo_sum;
+    normal_sum += other.normal_sum;
+    depth_sum += other.depth_sum;
+}
+
+color pixel_accumulator::mean() const {
+    if (count == 0) {
+        return color(0, 0, 0);
+    }
+    return sum / static_cast<float>(count);
+}
+
+sample_features pixel_accumulator::mean_features() const {
+    sample_features features;
+    if (count > 0) {
+        float inv_count = 1.0f / static_cast<float>(count);
+        features.albedo = albedo_sum * inv_count;
+        features.normal = normal_sum * inv_count;
+        features.depth = depth_sum * inv_count;
+    }
+    return features;
+}
+
+float pixel_accumulator::mean_variance() const {
+    if (count < 2) {
+        return 0.0f;
+    }
+    double n = count;
+    double mean_luminance = luminance_sum / n;
+    double variance = std::max(0.0, (luminance_sq_sum - luminance_sum * mean_luminance) / (n - 1));
+    return static_cast<float>(variance / n);
+}
+
+float pixel_accumulator::relative_error() const {
+    if (count < 2) {
+        return std::numeric_limits<float>::infinity();
+    }
+    double n = count;
+    double mean_luminance = luminance_sum / n;
+    double variance = std::max(0.0, (luminance_sq_sum - luminance_sum * mean_luminance) / (n - 1));
+    // Plancher sur la luminance : un pixel presque noir ne doit pas exiger une erreur nulle
+    return static_cast<float>(std::sqrt(variance / n) / std::max(mean_luminance, 0.01));
+}
+
+film::film(unsigned int w, unsigned int h) : width(w), height(h), pixels(w * h) {}
+
+uint32_t film::min_sample_count() const {
+    return min_sample_count(0, height);
+}
+
+uint32_t film::min_sample_count(unsigned int first_row, unsigned int end_row) const {
+    end_row = std::min(end_row, height);
+    if (width == 0 || first_row >= end_row) {
+        return 0;
+    }
+    uint32_t min_count = std::numeric_limits<uint32_t>::max();
+    for (unsigned int y = first_row; y < end_row; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            min_count = std::min(min_count, get(x, y).count);
+        }
+    }
+    return min_count;
+}
+
+Image film::resolve() const {
+    Image image(width, height);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            image.SetPixel(x, y, get(x, y).mean());
+        }
+    }
+    return image;
+}
+
+Image film::sample_count_image() const {
+    uint32_t max_count = 1;
+    for (const auto& pixel : pixels) {
+        max_count = std::max(max_count, pixel.count);
+    }
+
+    Image image(width, height);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            float level = static_cast<float>(get(x, y).count) / max_count;
+            image.SetPixel(x, y, color(level * level, level * level, level * level));
+        }
+    }
+    return image;
+}
+
+Image film::feature_image(film_feature feature) const {
+    float max_depth = 0.0f;
+    for (const auto& pixel : pixels) {
+        max_depth = std::max(max_depth, pixel.mean_features().depth);
+    }
+
+    Image image(width, height);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            sample_features features = get(x, y).mean_features();
+            color value = features.albedo;
+            if (feature == film_feature::normal) {
+                value = 0.5f * (features.normal + vector3(1, 1, 1));
+                value = value * value;
+            } else if (feature == film_feature::depth) {
+                float level = max_depth > 0.0f ? features.depth / max_depth : 0.0f;
+                value = color(level * level, level * level, level * level);
+            }
+            image.SetPixel(x, y, value);
+        }
+    }
+    return image;
+}
+
+bool film::save_checkpoint(const std::string& filename, const film_checkpoint_info& info) const {
+    checkpoint_header header{};
+    std::memcpy(header.magic, checkpoint_magic, sizeof(checkpoint_magic));
+    header.version = checkpoint_version;
+    header.width = width;
+    header.height = height;
+    header.target_samples = info.target_samples;
+    header.part_index = info.part_index;
+    header.part_count = info.part_count;
+    header.part_split = info.part_split;
+    header.seed = info.seed;
+    header.checksum = fnv1a(pixels.data(), pixels.size() * sizeof(pixel_accumulator));
+
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot write checkpoint: " << temporary << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(pixels.data()),
+                  pixels.size() * sizeof(pixel_accumulator));
+        out.close();
+        if (!out) {
+            std::cerr << "Cannot write checkpoint: " << temporary << std::endl;
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Cannot replace checkpoint: " << filename << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool film::load_checkpoint(const std::string& filename, film_checkpoint_info& info) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    checkpoint_header header{};
+    if (!read_header(in, filename, header)) {
+        return false;
+    }
+    if (header.width != width || header.height != height) {
+        std::cerr << "Checkpoint size mismatch: " << header.width << "x" << header.height
+                  << " instead of " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    std::vector<pixel_accumulator> loaded(pixels.size());
+    in.read(reinterpret_cast<char*>(loaded.data()), loaded.size() * sizeof(pixel_accumulator));
+    if (!in ||
+        fnv1a(loaded.data(), loaded.size() * sizeof(pixel_accumulator)) != header.checksum) {
+        std::cerr << "Corrupted checkpoint: " << filename << std::endl;
+        return false;
+    }
+
+    pixels = std::move(loaded);
+    info = checkpoint_info(header);
+    return true;
+}
+
+bool film::merge_checkpoint(const std::string& filename, film_checkpoint_info& info) {
+    film part(width, height);
+    if (!part.load_checkpoint(filename, info)) {
+        return false;
+    }
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i].merge(part.pixels[i]);
+    }
+    return true;
+}
+
+bool film::read_checkpoint_header(const std::string& filename, unsigned int& width,
+                                  unsigned int& height, film_checkpoint_info& info) {
+    std::ifstream in(filename, std::ios::binary);
+    checkpoint_header header{};
+    if (!in) {
+        std::cerr << "Cannot read checkpoint: " << filename << std::endl;
+        return false;
+    }
+    if (!read_header(in, filename, header)) {
+        return false;
+    }
+    width = header.width;
+    height = header.height;
+    info = checkpoint_info(header);
+    return true;
+}
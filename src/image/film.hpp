@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+#include "maths/vector3.hpp"
+
+/**
+ * @file film.hpp
+ * @brief Buffer d'accumulation des échantillons d'un rendu.
+ *
+ * Contrairement à `Image`, qui ne contient que la couleur finale, le film garde pour
+ * chaque pixel la somme des échantillons, les moments de leur luminance et leur
+ * nombre : il permet d'estimer le bruit d'un pixel et de continuer à l'affiner.
+ */
+
+/**
+ * @brief Attributs du premier point touché par un échantillon, qui guident le débruitage.
+ */
+struct sample_features {
+    color albedo = color(0, 0, 0);      // Couleur de surface (fond : couleur du fond)
+    vector3 normal = vector3(0, 0, 0);  // Normale côté caméra, nulle si le rayon s'échappe
+    float depth = 0.0f;                 // Distance à la caméra, 0 si le rayon s'échappe
+};
+
+/**
+ * @brief Statistiques des échantillons d'un pixel.
+ */
+struct pixel_accumulator {
+    color sum = color(0, 0, 0);
+    double luminance_sum = 0.0;
+    double luminance_sq_sum = 0.0;
+    uint32_t count = 0;
+
+    // Sommes des attributs du premier point touché
+    color albedo_sum = color(0, 0, 0);
+    vector3 normal_sum = vector3(0, 0, 0);
+    float depth_sum = 0.0f;
+
+    void add(const color& sample);
+
+    /** @brief Ajoute un échantillon et les attributs de son premier point touché. */
+    void add(const color& sample, const sample_features& features);
+
+    void merge(const pixel_accumulator& other);
+
+    /** @brief Moyenne des échantillons, noir si le pixel n'en a aucun. */
+    color mean() const;
+
+    /** @brief Moyenne des attributs des échantillons. */
+    sample_features mean_features() const;
+
+    /**
+     * @brief Variance de la moyenne de luminance (variance des échantillons / n).
+     * Nulle tant que le pixel a moins de deux échantillons.
+     */
+    float mean_variance() const;
+
+    /**
+     * @brief Erreur relative estimée de la moyenne de luminance.
+     *
+     * Écart-type de la moyenne (sqrt(variance / n)) divisé par la luminance moyenne.
+     * Infinie tant que le pixel a moins de deux échantillons.
+     */
+    float relative_error() const;
+};
+
+/** @brief Attributs du film exportables en image. */
+enum class film_feature { albedo, normal, depth };
+
+/**
+ * @brief Paramètres du rendu enregistrés avec un checkpoint.
+ */
+struct film_checkpoint_info {
+    uint64_t seed = 0;            // Graine du rendu : la reprise doit utiliser la même
+    uint32_t target_samples = 0;  // Échantillons par pixel visés lors de l'écriture
+    uint32_t part_index = 0;      // Partie d'un rendu distribué (0 sur 1 : rendu complet)
+    uint32_t part_count = 1;
+    uint32_t part_split = 0;  // Découpage des parties (valeur de `part_split`)
+};
+
+/**
+ * @class film
+ * @brief Accumulateurs par pixel, dans l'orientation de `Image` (ligne 0 en haut).
+ *
+ * Chaque pixel n'est écrit que par un thread à la fois (celui de sa tuile) : le film
+ * n'a pas de verrou.
+ */
+class film {
+public:
+    film(unsigned int w, unsigned int h);
+
+    unsigned int get_width() const {
+        return width;
+    }
+    unsigned int get_height() const {
+        return height;
+    }
+
+    const pixel_accumulator& get(unsigned int x, unsigned int y) const {
+        return pixels[y * width + x];
+    }
+
+    void set(unsigned int x, unsigned int y, const pixel_accumulator& pixel) {
+        pixels[y * width + x] = pixel;
+    }
+
+    void merge(unsigned int x, unsigned int y, const pixel_accumulator& samples) {
+        pixels[y * width + x].merge(samples);
+    }
+
+    /** @brief Plus petit nombre d'échantillons d'un pixel du film. */
+    uint32_t min_sample_count() const;
+
+    /** @brief Plus petit nombre d'échantillons d'un pixel des lignes [first_row, end_row). */
+    uint32_t min_sample_count(unsigned int first_row, unsigned int end_row) const;
+
+    /** @brief Image de la moyenne de chaque pixel. */
+    Image resolve() const;
+
+    /**
+     * @brief Image du nombre d'échantillons par pixel, du noir (0) au blanc (maximum).
+     *
+     * La valeur est élevée au carré pour compenser la correction gamma de
+     * `Image::WriteFile` : le niveau de gris du PNG est proportionnel au nombre.
+     */
+    Image sample_count_image() const;
+
+    /**
+     * @brief Image d'un attribut du premier point touché : albédo, normale (composantes
+     * ramenées de [-1, 1] à [0, 1]) ou profondeur (du noir, proche, au blanc, la plus
+     * lointaine). Normale et profondeur sont compensées de la correction gamma.
+     */
+    Image feature_image(film_feature feature) const;
+
+    /**
+     * @brief Écrit les accumulateurs dans un fichier binaire compact.
+     *
+     * Le fichier est écrit à côté puis renommé : une interruption pendant l'écriture
+     * laisse le checkpoint précédent intact.
+     *
+     * @return true si le fichier a été écrit
+     */
+    bool save_checkpoint(const std::string& filename, const film_checkpoint_info& info) const;
+
+    /**
+     * @brief Recharge les accumulateurs d'un checkpoint de mêmes dimensions.
+     * @return true si le fichier est valide (en-tête, dimensions, checksum) ; le film
+     * n'est pas modifié sinon
+     */
+    bool load_checkpoint(const std::string& filename, film_checkpoint_info& info);
+
+    /**
+     * @brief Ajoute aux pixels les échantillons d'un checkpoint de mêmes dimensions, par
+     * exemple le film d'une partie d'un rendu distribué.
+     * @return true si le fichier est valide ; le film n'est pas modifié sinon
+     */
+    bool merge_checkpoint(const std::string& filename, film_checkpoint_info& info);
+
+    /**
+     * @brief Lit les dimensions et les paramètres d'un checkpoint sans ses accumulateurs.
+     */
+    static bool read_checkpoint_header(const std::string& filename, unsigned int& width,
+                                       unsigned int& height, film_checkpoint_info& info);
+
+private:
+    unsigned int width;
+    unsigned int height;
+    std::vector<pixel_accumulator> pixels;
+};
@@ -0,0 +1,345 @@
+#include "thread_pool.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Pool, indice et noeud NUMA du worker courant (-1 et 0 hors d'un worker)
+thread_local const thread_pool* current_pool = nullptr;
+thread_local int current_index = -1;
+thread_local unsigned int current_node_index = 0;
+
+// Liste de coeurs au format du noyau : "0-3,8-11"
+std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            continue;
+        }
+    }
+    return cpus;
+}
+
+// Coeurs de chaque noeud NUMA ; un seul noeud si la topologie n'est pas disponible
+std::vector<std::vector<int>> detect_numa_nodes() {
+    std::vector<std::vector<int>> nodes;
+#ifdef __linux__
+    for (int node = 0; node < 1024; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) +
+                           "/cpulist");
+        std::string line;
+        if (file && std::getline(file, line)) {
+            std::vector<int> cpus = parse_cpu_list(line);
+            if (!cpus.empty()) {  // Les noeuds sans coeur (mémoire seule) sont ignorés
+                nodes.push_back(cpus);
+            }
+        }
+    }
+#endif
+    if (nodes.empty()) {
+        std::vector<int> cpus;
+        for (unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        nodes.push_back(cpus);
+    }
+
+#ifdef __linux__
+    // Seuls les coeurs autorisés au processus (cgroup, taskset) peuvent recevoir un thread
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        std::vector<std::vector<int>> usable;
+        for (const auto& node : nodes) {
+            std::vector<int> cpus;
+            for (int cpu : node) {
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty()) {
+                usable.push_back(cpus);
+            }
+        }
+        if (!usable.empty()) {
+            nodes = usable;
+        }
+    }
+#endif
+    return nodes;
+}
+
+// Restreint le thread courant aux coeurs donnés ; false si le système refuse
+bool set_thread_affinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;  // Épinglage non supporté : le système place les threads
+    return false;
+#endif
+}
+
+std::mutex shared_pool_mutex;
+
+std::unique_ptr<thread_pool>& shared_pool() {
+    static std::unique_ptr<thread_pool> pool;
+    return pool;
+}
+
+}  // namespace
+
+thread_pool::thread_pool(unsigned int num_threads)
+    : thread_pool(thread_pool_options{num_threads}) {}
+
+thread_pool::thread_pool(const thread_pool_options& options) {
+    unsigned int num_threads = options.num_threads;
+    if (num_threads == 0)
+        num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0)
+        num_threads = 4;
+
+    std::vector<std::vector<int>> nodes = detect_numa_nodes();
+    if (!options.numa_aware) {
+        // Un seul noeud logique regroupant tous les coeurs
+        std::vector<int> all_cpus;
+        for (const auto& node : nodes) {
+            all_cpus.insert(all_cpus.end(), node.begin(), node.end());
+        }
+        nodes = {all_cpus};
+    }
+    num_nodes = static_cast<unsigned int>(nodes.size());
+
+    // Workers répartis par blocs contigus : les voisins de file partagent le noeud
+    std::vector<std::vector<int>> worker_cpus(num_threads);
+    std::vector<unsigned int> placed(num_nodes, 0);
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        unsigned int node = i * num_nodes / num_threads;
+        worker_nodes.push_back(node);
+        const std::vector<int>& cpus = nodes[node];
+        if (options.pin_threads) {
+            worker_cpus[i] = {cpus[placed[node]++ % cpus.size()]};
+        } else if (options.numa_aware) {
+            worker_cpus[i] = cpus;
+        }
+    }
+
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        queues.push_back(std::make_unique<worker_queue>());
+    }
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        workers.emplace_back(&thread_pool::worker_loop, this, i, worker_cpus[i]);
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+thread_pool& thread_pool::instance() {
+    std::lock_guard<std::mutex> lock(shared_pool_mutex);
+    auto& pool = shared_pool();
+    if (!pool) {
+        pool = std::make_unique<thread_pool>();
+    }
+    return *pool;
+}
+
+void thread_pool::configure(const thread_pool_options& options) {
+    std::lock_guard<std::mutex> lock(shared_pool_mutex);
+    auto& pool = shared_pool();
+    pool.reset();
+    pool = std::make_unique<thread_pool>(options);
+}
+
+bool thread_pool::owns_current_thread() const {
+    return current_pool == this && current_index >= 0;
+}
+
+unsigned int thread_pool::current_node() {
+    return current_node_index;
+}
+
+void thread_pool::submit(std::function<void()> task) {
+    unsigned int index = current_pool == this && current_index >= 0
+                             ? static_cast<unsigned int>(current_index)
+                             : next_queue.fetch_add(1) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    pending.fetch_add(1);
+
+    // Le verrou garantit qu'un worker qui s'endort voit la nouvelle tâche
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    wake.notify_one();
+}
+
+bool thread_pool::run_pending_task() {
+    std::function<void()> task;
+    int self = current_pool == this ? current_index : -1;
+    if (!pop_task(self, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+bool thread_pool::pop_task(int self, std::function<void()>& task) {
+    // Sa propre file d'abord, par la fin
+    if (self >= 0) {
+        worker_queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Puis vol des tâches les plus anciennes des autres workers, du même noeud d'abord
+    size_t count = queues.size();
+    size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        bool local_pass = pass == 0 && self >= 0 && num_nodes > 1;
+        for (size_t i = 0; i < count; ++i) {
+            size_t victim = (start + i) % count;
+            if (static_cast<int>(victim) == self) {
+                continue;
+            }
+            if (self >= 0 && num_nodes > 1 &&
+                (worker_nodes[victim] == worker_nodes[self]) != local_pass) {
+                continue;
+            }
+            worker_queue& queue = *queues[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                pending.fetch_sub(1);
+                return true;
+            }
+        }
+        if (self < 0 || num_nodes == 1) {
+            break;  // Un seul passage suffit : toutes les files ont été visitées
+        }
+    }
+    return false;
+}
+
+void thread_pool::worker_loop(unsigned int index, std::vector<int> cpus) {
+    current_pool = this;
+    current_index = static_cast<int>(index);
+    current_node_index = worker_nodes[index];
+    if (!cpus.empty() && !set_thread_affinity(cpus)) {
+        std::cerr << "Cannot set the CPU affinity of worker " << index << " (" << cpus.size()
+                  << " CPU(s)); the system places it" << std::endl;
+    }
+
+    std::function<void()> task;
+    while (true) {
+        if (pop_task(current_index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this] { return stopping || pending.load() > 0; });
+        if (stopping && pending.load() == 0) {
+            return;
+        }
+    }
+}
+
+void task_group::run(std::function<void()> task) {
+    outstanding.fetch_add(1);
+    pool.submit([this, task = std::move(task)]() {
+        // La fin de la tâche est signalée même si elle lève une exception
+        struct completion {
+            task_group& group;
+            ~completion() {
+                // Décrément et notification sous le verrou : `finish` reprend le verrou
+                // avant de rendre la main, le groupe ne peut pas être détruit entretemps
+                std::lock_guard<std::mutex> lock(group.mutex);
+                group.outstanding.fetch_sub(1);
+                group.done.notify_all();
+            }
+        } guard{*this};
+
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    });
+}
+
+void task_group::finish() {
+    // Un thread extérieur au pool (le thread principal) ne fait qu'attendre : le pool
+    // tourne sur exactement `size()` threads, tous placés selon les réglages
+    if (!pool.owns_current_thread()) {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return outstanding.load() == 0; });
+        return;
+    }
+
+    while (outstanding.load() > 0) {
+        if (pool.run_pending_task()) {
+            continue;
+        }
+        // Plus rien à prendre : les tâches restantes tournent sur d'autres threads. Le
+        // réveil périodique permet d'aider aux tâches soumises entretemps
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait_for(lock, std::chrono::milliseconds(1),
+                      [this] { return outstanding.load() == 0; });
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+}
+
+void task_group::wait() {
+    finish();
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(failure, error);
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Réglages du pool : nombre de threads, épinglage et placement NUMA.
+ */
+struct thread_pool_options {
+    unsigned int num_threads = 0;  // 0 : `std::thread::hardware_concurrency()`
+    bool pin_threads = false;      // Chaque worker est fixé sur un coeur
+    bool numa_aware = false;       // Workers répartis par noeud NUMA, vol local en priorité
+};
+
+/**
+ * @brief Pool de threads persistant avec vol de tâches (work stealing).
+ *
+ * Chaque worker possède sa propre file : il dépile ses tâches par la fin (LIFO, les
+ * données sont encore chaudes en cache) et, quand elle est vide, vole les plus
+ * anciennes tâches des autres workers. Le pool partagé (`instance()`) est créé une
+ * seule fois par processus et sert au chargement des meshes, à la construction des
+ * BVH et au rendu : les threads ne sont plus recréés à chaque étape.
+ *
+ * En mode NUMA, les workers sont répartis par blocs sur les noeuds (lus dans
+ * /sys/devices/system/node sous Linux), restreints aux coeurs de leur noeud et volent
+ * d'abord les tâches des workers du même noeud. La mémoire touchée en premier par un
+ * worker (buffers de tuiles thread_local, répliques du BVH d'un snapshot) reste ainsi
+ * locale ; le film, alloué par le thread qui lance le rendu, ne l'est pas. Les coeurs
+ * hors de l'affinité du processus (cgroup, taskset) sont écartés.
+ *
+ * Usage:
+ * @code
+ * task_group group(thread_pool::instance());
+ * group.run([] { ... });
+ * group.wait();
+ * @endcode
+ */
+class thread_pool {
+public:
+    /**
+     * @brief Démarre les workers.
+     * @param num_threads Nombre de workers, 0 pour `std::thread::hardware_concurrency()`
+     */
+    explicit thread_pool(unsigned int num_threads = 0);
+
+    explicit thread_pool(const thread_pool_options& options);
+
+    ~thread_pool();
+
+    /** @brief Pool partagé par tout le processus, créé au premier appel. */
+    static thread_pool& instance();
+
+    /**
+     * @brief Recrée le pool partagé avec de nouveaux réglages.
+     *
+     * À appeler au démarrage, avant toute utilisation de `instance()` par d'autres
+     * threads : les références obtenues auparavant deviennent invalides.
+     */
+    static void configure(const thread_pool_options& options);
+
+    /** @brief Nombre de noeuds NUMA utilisés par le pool (1 hors mode NUMA). */
+    unsigned int node_count() const {
+        return num_nodes;
+    }
+
+    /**
+     * @brief Noeud NUMA du worker courant, 0 hors d'un worker.
+     *
+     * Permet aux données répliquées par noeud de choisir leur copie locale.
+     */
+    static unsigned int current_node();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /** @brief true si le thread appelant est un worker de ce pool. */
+    bool owns_current_thread() const;
+
+    /** @brief Nombre de workers : seuls threads qui exécutent les tâches du pool. */
+    unsigned int size() const {
+        return static_cast<unsigned int>(workers.size());
+    }
+
+    /**
+     * @brief Ajoute une tâche. Depuis un worker, elle va dans sa propre file ; sinon
+     * les files sont servies à tour de rôle.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Exécute une tâche en attente, si possible, sur le thread appelant.
+     * @return true si une tâche a été exécutée
+     */
+    bool run_pending_task();
+
+private:
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> workers;
+    std::vector<unsigned int> worker_nodes;  // Noeud NUMA de chaque worker
+    unsigned int num_nodes = 1;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending{0};
+    std::atomic<unsigned int> next_queue{0};
+    bool stopping = false;
+
+    void worker_loop(unsigned int index, std::vector<int> cpus);
+    bool pop_task(int self, std::function<void()>& task);
+};
+
+/**
+ * @brief Groupe de tâches dont on attend la fin.
+ *
+ * Depuis un worker, `wait` exécute les tâches en attente du pool tant qu'il y en a, puis
+ * dort jusqu'à la fin de la dernière tâche du groupe : un groupe peut donc être attendu
+ * depuis une tâche du même pool (construction récursive d'un BVH) sans risque
+ * d'interblocage. Un thread extérieur au pool ne fait que dormir : `--threads N` rend
+ * sur N threads.
+ *
+ * Une exception levée par une tâche est capturée ; la première est relancée par `wait`
+ * une fois toutes les tâches du groupe terminées.
+ */
+class task_group {
+public:
+    explicit task_group(thread_pool& pool) : pool(pool) {}
+
+    // Attend les tâches sans relancer leur exception : un destructeur ne doit pas lever
+    ~task_group() {
+        finish();
+    }
+
+    void run(std::function<void()> task);
+
+    /** @brief Attend la fin des tâches et relance la première exception levée. */
+    void wait();
+
+private:
+    thread_pool& pool;
+    std::atomic<size_t> outstanding{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;  // Première exception levée par une tâche
+
+    void finish();
+};
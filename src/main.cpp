@@ -1,3 +1,11 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "core/bvh_node.hpp"
@@ -5,18 +13,24 @@
 #include "core/hitrecord.hpp"
 #include "core/hittable_list.hpp"
 #include "core/ray.hpp"
+#include "image/film.hpp"
 #include "image/image.hpp"
 #include "lib/chrono_timer.hpp"
+#include "lib/thread_pool.hpp"
 #include "material/material.hpp"
+#include "maths/sampler.hpp"
+#include "scene/animation.hpp"
 #include "scene/scene.hpp"
+#include "scene/snapshot.hpp"
 #include "shape/cube.hpp"
 #include "shape/plane.hpp"
 #include "shape/read_mesh.hpp"
 #include "shape/sphere.hpp"
 #include "shape/triangle.hpp"
 
-int main() {
-    // Camera setup
+namespace {
+
+camera make_camera() {
     camera cam;
     cam.aspect_ratio = 16.0f / 9.0f;
     cam.image_width = 1920;
@@ -25,7 +39,65 @@ int main() {
     cam.focal_length = 1.0f;
     cam.samples_per_pixel = 50;
     cam.max_depth = 5;
+    return cam;
+}
+
+bool ends_with(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() &&
+           value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void print_usage() {
+    std::cerr << "Usage:\n"
+              << "  rayborn                                  Scene de demonstration\n"
+              << "  rayborn render <scene.json|scene.rbs> [output.png] [--stream]\n"
+              << "  rayborn compile <scene.json> <scene.rbs> [--stream]\n"
+              << "  rayborn watch <scene.json> [output.png]  Re-rendu a chaque modification\n"
+              << "  rayborn render <scene> <partie.film> --part <k/n> [--split samples|rows]\n"
+              << "                 Rend la partie k (de 0 a n-1) et ecrit son film\n"
+              << "  rayborn sequence <scene.json> <animation.json> [frame_####.png]\n"
+              << "                 Rend les images d'une animation sans recharger la scene\n"
+              << "  rayborn merge <output.png> <partie.film>...  Fusionne les parties en une image\n"
+              << "  rayborn distribute <scene> [output.png] --workers <n> [--split samples|rows]\n"
+              << "                 Rend n parties dans n processus locaux puis les fusionne\n"
+              << "Options:\n"
+              << "  --verify       Verifie le checksum d'un snapshot .rbs avant le rendu\n"
+              << "  --threads <n>  Nombre de threads (defaut : tous les coeurs)\n"
+              << "  --pin          Fixe chaque thread sur un coeur\n"
+              << "  --numa         Repartit les threads par noeud NUMA\n"
+              << "  --adaptive     Echantillonnage adaptatif (--spp devient un plafond)\n"
+              << "  --spp <n>      Echantillons par pixel\n"
+              << "  --sample-count <image.png>  Image du nombre d'echantillons par pixel\n"
+              << "  --progressive <n>  Passes de n echantillons, image mise a jour entre deux\n"
+              << "  --snapshot-every <s>  Mise a jour de l'image au plus toutes les s secondes\n"
+              << "  --time-budget <s>  Arrete le rendu apres s secondes (ou avant, une fois\n"
+              << "                 --spp atteint : --spp reste un plafond)\n"
+              << "  --quality-floor <n>  Echantillons minimaux par pixel (code de retour 2 sinon)\n"
+              << "  --seed <n>     Graine du rendu\n"
+              << "  --checkpoint <fichier>  Sauvegarde periodique du rendu en cours\n"
+              << "  --resume       Reprend depuis le checkpoint\n"
+              << "  --packet <n>   Rayons primaires par paquet : 4, 8, 16 (1 : rayons isoles)\n"
+              << "  --wavefront <n>  Integrateur wavefront, n chemins en vol par lot\n"
+              << "  --sort-rays    Mode wavefront : tri des rayons secondaires avant trace\n"
+              << "  --sampler <independent|stratified|sobol>  Echantillonneur (defaut : sobol)\n"
+              << "  --no-light-sampling  Sans eclairage direct : les sources ne sont vues que par\n"
+              << "                 les rebonds\n"
+              << "  --denoise      Debruite l'image finale (albedo, normale, profondeur)\n"
+              << "  --denoise-strength <s>  Force du debruitage (defaut : 1, 0 : aucun)\n"
+              << "  --features <prefixe>  Images d'attributs : prefixe_albedo.png, _normal, _depth\n";
+}
+
+// Charge une scène JSON sans construire le BVH global
+bool load_json_scene(const std::string& path, bool streaming, hittable_list& world) {
+    if (streaming) {
+        stream_scene_from_json_file(path, world);
+    } else {
+        load_scene_from_json_file(path, world);
+    }
+    return !world.objects.empty();
+}
 
+int render_demo(camera cam) {
     // World
     hittable_list world;
 
@@ -53,19 +125,432 @@ int main() {
     read_mesh dino_loader("dino.obj", &world, material_dino, 0.1f, point3(-2, -0.5, -6));
     dino_loader.add_mesh();
 
-    world = hittable_list(make_shared<bvh_node>(world));
+    world = hittable_list(make_shared<bvh_node>(world, &thread_pool::instance()));
 
     // Render
     cam.render(world, "scene_with_mesh.png");
 
-    // // === Load and render scene from JSON ===
-    // hittable_list json_world;
-    // load_scene_from_json_file("scene.json", json_world);
+    return 0;
+}
+
+int render_scene(const std::string& scene_path, const std::string& output, bool streaming,
+                 bool verify_snapshot, camera cam) {
+    Chrono load_timer;
+    load_timer.start();
 
-    // if (!json_world.objects.empty()) {
-    //     json_world = hittable_list(make_shared<bvh_node>(json_world));
-    //     cam.render(json_world, "scene_from_json.png");
-    // }
+    hittable_list world;
+    if (ends_with(scene_path, ".rbs")) {
+        auto snapshot = load_scene_snapshot(scene_path, verify_snapshot);
+        if (!snapshot) {
+            return 1;
+        }
+        world.add(snapshot);
+    } else {
+        if (!load_json_scene(scene_path, streaming, world)) {
+            std::cerr << "Empty scene: " << scene_path << std::endl;
+            return 1;
+        }
+        world = hittable_list(make_shared<bvh_node>(world, &thread_pool::instance()));
+    }
+    load_timer.log("Scene ready");
+
+    // Code de retour distinct quand le budget de temps n'a pas suffi au plancher de qualité
+    camera::render_stats stats = cam.render(world, output);
+    return stats.floor_reached ? 0 : 2;
+}
 
+int compile_scene(const std::string& scene_path, const std::string& output, bool streaming) {
+    Chrono compile_timer;
+    compile_timer.start();
+
+    hittable_list world;
+    if (!load_json_scene(scene_path, streaming, world)) {
+        std::cerr << "Empty scene: " << scene_path << std::endl;
+        return 1;
+    }
+    if (!write_scene_snapshot(world, output)) {
+        return 1;
+    }
+
+    compile_timer.log("Compilation finished");
     return 0;
 }
+
+// Fusionne les films des parties d'un rendu distribué et écrit l'image
+int merge_parts(const std::vector<std::string>& parts, const std::string& output, camera cam) {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    film_checkpoint_info info;
+    if (parts.empty() || !film::read_checkpoint_header(parts[0], width, height, info)) {
+        return 1;
+    }
+
+    if (info.part_count == 0 || info.part_count > parts.size()) {
+        std::cerr << "Missing parts: " << info.part_count << " expected, " << parts.size()
+                  << " given" << std::endl;
+        return 1;
+    }
+
+    film merged(width, height);
+    std::vector<bool> seen(info.part_count, false);
+    for (const auto& part : parts) {
+        film_checkpoint_info part_info;
+        if (!merged.merge_checkpoint(part, part_info)) {
+            std::cerr << "Cannot merge part: " << part << std::endl;
+            return 1;
+        }
+        // Une graine différente donnerait des échantillons corrélés ou redondants
+        if (part_info.seed != info.seed) {
+            std::cerr << "Part seed mismatch: " << part << std::endl;
+            return 1;
+        }
+        // Chaque partie d'un même découpage, une seule fois
+        if (part_info.part_count != info.part_count || part_info.part_split != info.part_split ||
+            part_info.part_index >= part_info.part_count) {
+            std::cerr << "Part split mismatch: " << part << std::endl;
+            return 1;
+        }
+        if (seen[part_info.part_index]) {
+            std::cerr << "Duplicate part " << part_info.part_index << ": " << part << std::endl;
+            return 1;
+        }
+        seen[part_info.part_index] = true;
+    }
+    for (uint32_t k = 0; k < info.part_count; ++k) {
+        if (!seen[k]) {
+            std::cerr << "Missing part " << k << "/" << info.part_count << std::endl;
+            return 1;
+        }
+    }
+
+    cam.write_image(merged, output);
+    std::cout << "Merged " << parts.size() << " parts into " << output << " ("
+              << merged.min_sample_count() << " spp min)" << std::endl;
+
+    // Parties manquantes ou interrompues : même code de retour que le plancher de qualité
+    uint32_t expected = cam.quality_floor > 0 ? static_cast<uint32_t>(cam.quality_floor)
+                                              : info.target_samples;
+    if (merged.min_sample_count() < expected) {
+        std::cerr << "Missing samples: " << merged.min_sample_count() << " < " << expected
+                  << " samples per pixel" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+// Argument protégé pour le shell
+std::string shell_quote(const std::string& value) {
+    std::string quoted = "'";
+    for (char c : value) {
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+// Rendu distribué sur la machine locale : un processus par partie, qui écrit son film à
+// côté de l'image, puis fusion. Sur plusieurs machines, les mêmes commandes `render
+// --part` sont lancées sur chaque noeud vers un répertoire partagé, suivies de `merge`
+int distribute_render(const std::string& executable, const std::string& scene_path,
+                      const std::string& output, int workers, part_split split,
+                      const std::vector<std::string>& forwarded, const camera& cam) {
+    std::vector<std::string> parts;
+    std::vector<int> results(workers, 0);
+    std::vector<std::thread> launchers;
+    for (int k = 0; k < workers; ++k) {
+        parts.push_back(output + ".part" + std::to_string(k) + ".film");
+        std::string command = shell_quote(executable) + " render " + shell_quote(scene_path) +
+                              " " + shell_quote(parts.back()) + " --part " + std::to_string(k) +
+                              "/" + std::to_string(workers) + " --split " +
+                              (split == part_split::rows ? "rows" : "samples");
+        for (const auto& arg : forwarded) {
+            command += " " + shell_quote(arg);
+        }
+        launchers.emplace_back([&results, k, command] {
+            results[k] = std::system(command.c_str());
+        });
+    }
+    for (auto& launcher : launchers) {
+        launcher.join();
+    }
+    for (int k = 0; k < workers; ++k) {
+        if (results[k] != 0) {
+            std::cerr << "Worker " << k << " failed: " << parts[k] << std::endl;
+            return 1;
+        }
+    }
+
+    int status = merge_parts(parts, output, cam);
+    if (status != 1) {
+        for (const auto& part : parts) {
+            std::remove(part.c_str());
+        }
+    }
+    return status;
+}
+
+bool parse_part(const std::string& value, render_part& part) {
+    size_t slash = value.find('/');
+    if (slash == std::string::npos) {
+        return false;
+    }
+    part.index = std::atoi(value.substr(0, slash).c_str());
+    part.count = std::atoi(value.substr(slash + 1).c_str());
+    return part.count > 0 && part.index >= 0 && part.index < part.count;
+}
+
+bool parse_part_split(const std::string& name, part_split& split) {
+    if (name == "samples") {
+        split = part_split::samples;
+    } else if (name == "rows") {
+        split = part_split::rows;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::filesystem::file_time_type> modification_times(
+    const std::vector<std::string>& files) {
+    std::vector<std::filesystem::file_time_type> times;
+    for (const auto& file : files) {
+        std::error_code ec;
+        times.push_back(std::filesystem::last_write_time(file, ec));
+    }
+    return times;
+}
+
+// Boucle de look-dev : recharge la scène de façon incrémentale à chaque modification
+int watch_scene(const std::string& scene_path, const std::string& output, camera cam) {
+    scene_session session;
+
+    while (true) {
+        auto status = session.reload(scene_path);
+        if (status == scene_session::reload_status::changed) {
+            cam.render(session.get_world(), output);
+        } else if (status == scene_session::reload_status::failed) {
+            std::cerr << "Scene not reloaded, previous image kept" << std::endl;
+        }
+
+        std::vector<std::string> files = session.watched_files();
+        if (files.empty()) {
+            files.push_back(scene_path);
+        }
+        auto times = modification_times(files);
+        std::cout << "Watching " << scene_path << " (Ctrl+C pour quitter)..." << std::endl;
+        while (modification_times(files) == times) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        }
+    }
+}
+
+// Séquence animée : scène, meshes et pool ne sont chargés qu'une fois. Chaque image place
+// la caméra et les objets animés ; le BVH de premier niveau n'est refait que si un objet a
+// bougé. L'image N est débruitée, encodée et écrite par un thread dédié pendant le rendu
+// de l'image N + 1
+int render_sequence(const std::string& scene_path, const std::string& animation_path,
+                    const std::string& pattern, camera cam) {
+    animation anim;
+    if (!load_animation(animation_path, anim)) {
+        return 1;
+    }
+    scene_session session;
+    if (session.reload(scene_path) == scene_session::reload_status::failed) {
+        return 1;
+    }
+    if (session.get_world().objects.empty()) {
+        std::cerr << "Empty scene: " << scene_path << std::endl;
+        return 1;
+    }
+
+    auto directory = std::filesystem::path(frame_filename(pattern, 0)).parent_path();
+    std::error_code ec;
+    if (!directory.empty() && !std::filesystem::create_directories(directory, ec) && ec) {
+        std::cerr << "Cannot create directory: " << directory.string() << std::endl;
+        return 1;
+    }
+
+    // Un checkpoint ne décrit qu'une image : sans objet pour une séquence
+    cam.checkpoint_file.clear();
+    cam.resume = false;
+
+    Chrono sequence_timer;
+    sequence_timer.start();
+    std::thread pending;  // Écriture de l'image précédente
+    int status = 0;
+    for (int frame = 0; frame < anim.frame_count; ++frame) {
+        session.apply_offsets(anim.object_offsets(frame));
+        anim.place_camera(frame, cam);
+        std::string output = frame_filename(pattern, frame);
+        std::cout << "Frame " << frame + 1 << "/" << anim.frame_count << " -> " << output
+                  << std::endl;
+
+        film accumulation(0, 0);
+        if (!cam.render_film(session.get_world(), accumulation, output).floor_reached) {
+            status = 2;
+        }
+
+        // Copie de la caméra : les images annexes portent elles aussi le numéro de l'image
+        camera writer = cam;
+        if (!writer.sample_count_output.empty()) {
+            writer.sample_count_output = frame_filename(cam.sample_count_output, frame);
+        }
+        if (!writer.feature_output.empty()) {
+            writer.feature_output = frame_filename(cam.feature_output, frame);
+        }
+        if (pending.joinable()) {
+            pending.join();
+        }
+        pending = std::thread(
+            [writer = std::move(writer), accumulation = std::move(accumulation), output] {
+                writer.write_image(accumulation, output);
+            });
+    }
+    if (pending.joinable()) {
+        pending.join();
+    }
+    sequence_timer.log("Sequence: " + std::to_string(anim.frame_count) + " images");
+    return status;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> positional;
+    bool streaming = false;
+    bool verify_snapshot = false;
+    thread_pool_options pool_options;
+    camera cam = make_camera();
+    sampler_type sampling = sampler_type::sobol;
+    int workers = 0;
+    // Options transmises aux processus de `distribute`, sauf celles propres à une partie ou
+    // à un fichier unique
+    std::vector<std::string> forwarded;
+    const std::vector<std::string> local_options = {"--part", "--split", "--workers",
+                                                    "--checkpoint", "--resume"};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        int first = i;
+        if (arg == "--stream") {
+            streaming = true;
+        } else if (arg == "--verify") {
+            verify_snapshot = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            int threads = std::atoi(argv[++i]);
+            if (threads <= 0) {
+                std::cerr << "Invalid thread count: " << argv[i] << std::endl;
+                return 1;
+            }
+            pool_options.num_threads = static_cast<unsigned int>(threads);
+        } else if (arg == "--pin") {
+            pool_options.pin_threads = true;
+        } else if (arg == "--numa") {
+            pool_options.numa_aware = true;
+        } else if (arg == "--adaptive") {
+            cam.adaptive_sampling = true;
+        } else if (arg == "--spp" && i + 1 < argc) {
+            cam.samples_per_pixel = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sample-count" && i + 1 < argc) {
+            cam.sample_count_output = argv[++i];
+        } else if (arg == "--progressive" && i + 1 < argc) {
+            cam.pass_samples = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--snapshot-every" && i + 1 < argc) {
+            cam.snapshot_interval = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--time-budget" && i + 1 < argc) {
+            cam.time_budget = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--quality-floor" && i + 1 < argc) {
+            cam.quality_floor = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            cam.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            cam.checkpoint_file = argv[++i];
+        } else if (arg == "--resume") {
+            cam.resume = true;
+        } else if (arg == "--packet" && i + 1 < argc) {
+            cam.packet_size = std::clamp(std::atoi(argv[++i]), 1, ray_packet::max_size);
+        } else if (arg == "--wavefront" && i + 1 < argc) {
+            cam.wavefront_batch = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sort-rays") {
+            cam.sort_rays = true;
+        } else if (arg == "--no-light-sampling") {
+            cam.sample_lights = false;
+        } else if (arg == "--denoise") {
+            cam.denoise = true;
+        } else if (arg == "--denoise-strength" && i + 1 < argc) {
+            cam.denoise = true;
+            cam.denoising.strength = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--features" && i + 1 < argc) {
+            cam.feature_output = argv[++i];
+        } else if (arg == "--sampler" && i + 1 < argc) {
+            if (!parse_sampler_type(argv[++i], sampling)) {
+                std::cerr << "Unknown sampler: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--part" && i + 1 < argc) {
+            if (!parse_part(argv[++i], cam.part)) {
+                std::cerr << "Invalid part (k/n, 0 <= k < n): " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--split" && i + 1 < argc) {
+            if (!parse_part_split(argv[++i], cam.part.split)) {
+                std::cerr << "Unknown split: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--workers" && i + 1 < argc) {
+            workers = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else {
+            positional.push_back(arg);
+            continue;
+        }
+        if (std::find(local_options.begin(), local_options.end(), arg) == local_options.end()) {
+            forwarded.insert(forwarded.end(), argv + first, argv + i + 1);
+        }
+    }
+
+    cam.pixel_sampler = make_sampler(sampling, cam.samples_per_pixel);
+
+    // Le pool est créé avant tout chargement : meshes, BVH et rendu l'utilisent
+    thread_pool::configure(pool_options);
+
+    if (positional.empty()) {
+        return render_demo(cam);
+    }
+
+    const std::string& mode = positional[0];
+    if (mode == "render" && (positional.size() == 2 || positional.size() == 3)) {
+        std::string output = positional.size() == 3 ? positional[2] : "scene.png";
+        return render_scene(positional[1], output, streaming, verify_snapshot, cam);
+    }
+    if (mode == "watch" && (positional.size() == 2 || positional.size() == 3)) {
+        std::string output = positional.size() == 3 ? positional[2] : "scene.png";
+        return watch_scene(positional[1], output, cam);
+    }
+    if (mode == "sequence" && (positional.size() == 3 || positional.size() == 4)) {
+        std::string pattern = positional.size() == 4 ? positional[3] : "frame_####.png";
+        return render_sequence(positional[1], positional[2], pattern, cam);
+    }
+    if (mode == "compile" && positional.size() == 3) {
+        return compile_scene(positional[1], positional[2], streaming);
+    }
+    if (mode == "merge" && positional.size() >= 3) {
+        std::vector<std::string> parts(positional.begin() + 2, positional.end());
+        return merge_parts(parts, positional[1], cam);
+    }
+    if (mode == "distribute" && (positional.size() == 2 || positional.size() == 3) &&
+        workers > 0) {
+        std::string output = positional.size() == 3 ? positional[2] : "scene.png";
+        // Sans --threads, les coeurs sont partagés entre les processus locaux
+        if (pool_options.num_threads == 0) {
+            unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+            forwarded.push_back("--threads");
+            forwarded.push_back(std::to_string(std::max(1u, cores / workers)));
+        }
+        return distribute_render(argv[0], positional[1], output, workers, cam.part.split,
+                                 forwarded, cam);
+    }
+
+    print_usage();
+    return 1;
+}
@@ -2,6 +2,7 @@
 
 #include "core/hitrecord.hpp"
 #include "core/ray.hpp"
+#include "maths/sampler.hpp"
 #include "maths/vector3.hpp"
 
 // Lambertian material
@@ -9,7 +10,7 @@ lambertian::lambertian(const color& albedo) : albedo(albedo) {}
 
 bool lambertian::scatter(const ray& r_in, const HitRecord& rec, color& attenuation,
                          ray& scattered) const {
-    auto scatter_direction = rec.normal + random_unit_vector();
+    auto scatter_direction = rec.normal + sample_unit_vector();
     if (scatter_direction.near_zero())
         scatter_direction = rec.normal;
     scattered = ray(rec.p, scatter_direction);
@@ -17,6 +18,18 @@ bool lambertian::scatter(const ray& r_in, const HitRecord& rec, color& attenuati
     return true;
 }
 
+bool lambertian::evaluate(const HitRecord& rec, const vector3& direction, color& value,
+                          float& pdf) const {
+    // `scatter` tire normale + direction uniforme : densité cos / pi
+    float cosine = dot(rec.normal, unit_vector(direction));
+    if (cosine <= 0.0f) {
+        return false;
+    }
+    pdf = cosine / static_cast<float>(pi);
+    value = albedo * pdf;
+    return true;
+}
+
 // Metal material
 metal::metal(const color& albedo) : albedo(albedo) {}
 
@@ -26,4 +39,7 @@ bool metal::scatter(const ray& r_in, const HitRecord& rec, color& attenuation,
     scattered = ray(rec.p, reflected);
     attenuation = albedo;
     return true;
-}
\ No newline at end of file
+}
+
+// Diffuse light
+diffuse_light::diffuse_light(const color& emission) : emission(emission) {}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "core/hittable.hpp"
 #include "core/ray.hpp"
 #include "maths/vector3.hpp"
@@ -14,6 +16,14 @@ class HitRecord;
  * interagir avec les rayons lumineux (réflexion, réfraction, absorption, etc.).
  */
 
+/**
+ * @brief Famille d'un matériau : l'intégrateur wavefront ombre ensemble les points
+ * d'une même famille.
+ */
+enum class material_type { other, lambertian, metal };
+
+constexpr int material_type_count = 3;
+
 /**
  * @class material
  * @brief Classe de base abstraite pour les matériaux.
@@ -37,8 +47,42 @@ public:
                          ray& scattered) const {
         return false;
     }
+
+    /**
+     * @brief Évalue la diffusion vers une direction donnée, pour l'éclairage direct.
+     *
+     * @param rec Le point d'intersection (normale orientée vers le rayon incident)
+     * @param direction La direction sortante, non nécessairement unitaire
+     * @param value BSDF multipliée par le cosinus avec la normale
+     * @param pdf Densité, en angle solide, avec laquelle `scatter` tire cette direction
+     * @return false pour un matériau spéculaire (non évaluable) ou une direction sous la
+     * surface
+     */
+    virtual bool evaluate(const HitRecord& rec, const vector3& direction, color& value,
+                          float& pdf) const {
+        return false;
+    }
+
+    /** @brief Radiance émise, identique dans toutes les directions et des deux côtés. */
+    virtual color emitted() const {
+        return color(0, 0, 0);
+    }
+
+    /** @brief Couleur de surface vue par le débruiteur (attribut « albédo » du film). */
+    virtual color base_color() const {
+        return color(1, 1, 1);
+    }
+
+    virtual material_type type() const {
+        return material_type::other;
+    }
 };
 
+/** @brief Le matériau émet-il de la lumière ? */
+inline bool is_emissive(const material* mat) {
+    return mat && !mat->emitted().near_zero();
+}
+
 /**
  * @class lambertian
  * @brief Matériau diffus (matte) qui disperse la lumière uniformément.
@@ -48,6 +92,20 @@ public:
     lambertian(const color& albedo);
     bool scatter(const ray& r_in, const HitRecord& rec, color& attenuation,
                  ray& scattered) const override;
+    bool evaluate(const HitRecord& rec, const vector3& direction, color& value,
+                  float& pdf) const override;
+
+    material_type type() const override {
+        return material_type::lambertian;
+    }
+
+    color base_color() const override {
+        return albedo;
+    }
+
+    const color& get_albedo() const {
+        return albedo;
+    }
 
 private:
     color albedo;
@@ -63,6 +121,40 @@ public:
     bool scatter(const ray& r_in, const HitRecord& rec, color& attenuation,
                  ray& scattered) const override;
 
+    material_type type() const override {
+        return material_type::metal;
+    }
+
+    color base_color() const override {
+        return albedo;
+    }
+
+    const color& get_albedo() const {
+        return albedo;
+    }
+
 private:
     color albedo;
 };
+
+/**
+ * @class diffuse_light
+ * @brief Source de lumière surfacique : émet `emission` et absorbe tout rayon incident.
+ */
+class diffuse_light : public material {
+public:
+    diffuse_light(const color& emission);
+
+    color emitted() const override {
+        return emission;
+    }
+
+    // Émission ramenée dans [0, 1] : les sources restent distinctes des surfaces voisines
+    color base_color() const override {
+        return color(std::min(emission.x(), 1.0f), std::min(emission.y(), 1.0f),
+                     std::min(emission.z(), 1.0f));
+    }
+
+private:
+    color emission;
+};
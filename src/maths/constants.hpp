@@ -1,8 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
 #include <limits>
-#include <random>
 
 // Mathematical Constants
 inline constexpr double infinity = std::numeric_limits<double>::infinity();
@@ -13,14 +13,96 @@ inline double degrees_to_radians(double degrees) {
     return degrees * pi / 180.0;
 }
 
+/**
+ * @brief Générateur PCG32 (XSH-RR) : 64 bits d'état, réensemencement quasi gratuit.
+ *
+ * Le rendu réensemence le générateur du thread avant chaque échantillon : le résultat
+ * ne dépend alors ni du thread ni de l'ordre des tuiles, ce qui rend les rendus
+ * reproductibles et reprenables.
+ */
+struct pcg32 {
+    uint64_t state = 0x853c49e6748fea9bULL;
+    uint64_t inc = 0xda3e39cb94b95bdbULL;
+
+    void seed(uint64_t init_state, uint64_t sequence = 0) {
+        state = 0;
+        inc = (sequence << 1u) | 1u;
+        next();
+        state += init_state;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old_state = state;
+        state = old_state * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = static_cast<uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+        uint32_t rot = static_cast<uint32_t>(old_state >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+};
+
+/**
+ * @brief Générateur du thread. Son état initial est fixe : un même programme donne les
+ * mêmes tirages à chaque exécution ; le rendu le réensemence avant chaque échantillon.
+ */
+inline pcg32& random_generator() {
+    thread_local pcg32 generator;
+    return generator;
+}
+
+inline void seed_random(uint64_t seed) {
+    random_generator().seed(seed);
+}
+
+/** @brief Flottant uniforme dans [0, 1) tiré des 24 bits de poids fort. */
+inline float unit_float(uint32_t bits) {
+    return static_cast<float>(bits >> 8) * (1.0f / 16777216.0f);
+}
+
 inline float random_float() {
-    thread_local static std::mt19937* generator = nullptr;
-    if (!generator) {
-        std::random_device rd;
-        generator = new std::mt19937(rd());
+    return unit_float(random_generator().next());
+}
+
+// Fonction de hachage 32 bits à faible biais (lowbias32, C. Wellons)
+inline uint32_t hash_32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Générateur à compteur : tirage numéro `counter` du flux `key`.
+ *
+ * Sans état, donc sans ordre imposé : un échantillon peut tirer sa dimension `counter`
+ * directement, et la valeur ne dépend ni du thread ni de ce qui a été tiré avant. La
+ * clé regroupe graine, pixel et rang de l'échantillon (voir `counter_key`).
+ */
+inline uint32_t counter_random(uint64_t key, uint32_t counter) {
+    uint32_t mixed = hash_32(counter ^ static_cast<uint32_t>(key));
+    return hash_32(mixed + static_cast<uint32_t>(key >> 32));
+}
+
+/** @brief Clé du flux d'un échantillon : graine (déjà mêlée au pixel) et rang. */
+inline uint64_t counter_key(uint64_t seed, uint32_t index) {
+    uint64_t h = seed ^ ((static_cast<uint64_t>(index) + 1) * 0x9e3779b97f4a7c15ULL);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+/**
+ * @brief Tirages `first` à `first + count - 1` du flux `key`, d'un seul coup.
+ *
+ * Mêmes valeurs que `counter_random` appelé pour chaque compteur ; aucun tirage ne
+ * dépend du précédent.
+ */
+inline void counter_random_floats(uint64_t key, uint32_t first, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = unit_float(counter_random(key, first + static_cast<uint32_t>(i)));
     }
-    thread_local static std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
-    return distribution(*generator);
 }
 
 inline float random_float(float min, float max) {
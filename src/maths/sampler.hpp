@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "constants.hpp"
+#include "vector3.hpp"
+
+/**
+ * @file sampler.hpp
+ * @brief Échantillonneurs : nombres aléatoires indexés par (pixel, échantillon, dimension).
+ *
+ * Un échantillonneur fournit, pour l'échantillon `index` d'un pixel, une valeur par
+ * dimension : les dimensions 0 et 1 placent le rayon dans le pixel, les suivantes
+ * choisissent les directions des rebonds, deux par rebond. Un échantillonneur à faible
+ * discrépance répartit ces points bien plus uniformément que des tirages indépendants :
+ * le bruit décroît plus vite avec le nombre d'échantillons.
+ *
+ * Le rendu ouvre chaque échantillon avec `start_sample` ; les matériaux tirent ensuite
+ * leurs dimensions avec `next_2d`, sans connaître le pixel.
+ */
+
+/** @brief Point de [0, 1)². */
+struct sample_2d {
+    float u;
+    float v;
+};
+
+/**
+ * @brief Interface des échantillonneurs.
+ *
+ * Les implémentations sont sans état : la valeur d'une dimension ne dépend que de ses
+ * arguments.
+ */
+class sampler {
+public:
+    virtual ~sampler() = default;
+
+    /**
+     * @brief Dimensions `dimension` et `dimension + 1` d'un échantillon.
+     * @param pixel_seed Graine du pixel (décorrèle les pixels entre eux)
+     * @param index Rang de l'échantillon dans le pixel
+     * @param dimension Première dimension, paire
+     */
+    virtual sample_2d get_2d(uint64_t pixel_seed, uint32_t index, uint32_t dimension) const = 0;
+};
+
+/**
+ * @brief Tirages indépendants, issus du générateur à compteur : chaque dimension de
+ * chaque échantillon est tirée directement, sans dépendre des tirages précédents.
+ */
+class independent_sampler : public sampler {
+public:
+    sample_2d get_2d(uint64_t pixel_seed, uint32_t index, uint32_t dimension) const override {
+        float values[2];
+        counter_random_floats(counter_key(pixel_seed, index), dimension, values, 2);
+        return {values[0], values[1]};
+    }
+};
+
+/**
+ * @brief Échantillonnage stratifié : les `n x n` premiers échantillons d'un pixel
+ * tombent chacun dans une strate différente d'une grille n x n (n = partie entière de
+ * la racine de `samples_per_pixel`), dans un ordre mélangé propre à chaque pixel et à
+ * chaque dimension. Les échantillons suivants sont indépendants.
+ */
+class stratified_sampler : public sampler {
+public:
+    explicit stratified_sampler(int samples_per_pixel)
+        : grid(std::max(1u, static_cast<uint32_t>(std::sqrt(std::max(1, samples_per_pixel))))) {}
+
+    sample_2d get_2d(uint64_t pixel_seed, uint32_t index, uint32_t dimension) const override;
+
+private:
+    uint32_t grid;
+};
+
+/**
+ * @brief Suite de Sobol à deux dimensions, brouillée par la méthode d'Owen.
+ *
+ * Chaque paire de dimensions utilise les deux premières dimensions de Sobol avec son
+ * propre brouillage d'Owen (permutation par hachage de Laine-Karras) et son propre
+ * mélange des indices (Burley, "Practical Hash-based Owen Scrambling", 2020) : les
+ * paires restent décorrélées sans table de nombres directeurs, et chaque pixel reçoit
+ * un ensemble de points différent, sans motif visible.
+ */
+class sobol_sampler : public sampler {
+public:
+    sample_2d get_2d(uint64_t pixel_seed, uint32_t index, uint32_t dimension) const override;
+};
+
+namespace sampling {
+
+inline uint32_t reverse_bits(uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+    x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+// Permutation de Laine-Karras : chaque bit ne dépend que des bits de poids plus faible
+inline uint32_t laine_karras_permutation(uint32_t x, uint32_t seed) {
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+// Brouillage d'Owen en base 2 d'une valeur dont le bit de poids fort est le premier chiffre
+inline uint32_t nested_uniform_scramble(uint32_t x, uint32_t seed) {
+    return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+}
+
+// Deuxième dimension de Sobol : nombres directeurs v_1 = 2^31, v_i = v_(i-1) ^ (v_(i-1) >> 1)
+inline uint32_t sobol_second_dimension(uint32_t index) {
+    uint32_t result = 0;
+    for (uint32_t v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1) {
+        if (index & 1u) {
+            result ^= v;
+        }
+    }
+    return result;
+}
+
+inline uint32_t hash_combine(uint64_t seed, uint32_t value) {
+    uint64_t h = seed ^ (static_cast<uint64_t>(value) * 0x9e3779b97f4a7c15ULL);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<uint32_t>(h ^ (h >> 31));
+}
+
+// Permutation de [0, count) indexée par une graine (Kensler, "Correlated Multi-Jittered
+// Sampling", 2013)
+inline uint32_t permute(uint32_t i, uint32_t count, uint32_t seed) {
+    uint32_t mask = count - 1;
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+    do {
+        i ^= seed;
+        i *= 0xe170893du;
+        i ^= seed >> 16;
+        i ^= (i & mask) >> 4;
+        i ^= seed >> 8;
+        i *= 0x0929eb3fu;
+        i ^= seed >> 23;
+        i ^= (i & mask) >> 1;
+        i *= 1 | seed >> 27;
+        i *= 0x6935fa69u;
+        i ^= (i & mask) >> 11;
+        i *= 0x74dcb303u;
+        i ^= (i & mask) >> 2;
+        i *= 0x9e501cc3u;
+        i ^= (i & mask) >> 2;
+        i *= 0xc860a3dfu;
+        i &= mask;
+        i ^= i >> 5;
+    } while (i >= count);
+    return (i + seed) % count;
+}
+
+}  // namespace sampling
+
+inline sample_2d stratified_sampler::get_2d(uint64_t pixel_seed, uint32_t index,
+                                            uint32_t dimension) const {
+    float jitter[2];
+    counter_random_floats(counter_key(pixel_seed, index), dimension, jitter, 2);
+    uint32_t strata = grid * grid;
+    if (index >= strata) {
+        return {jitter[0], jitter[1]};
+    }
+    uint32_t stratum =
+        sampling::permute(index, strata, sampling::hash_combine(pixel_seed, dimension));
+    float u = (static_cast<float>(stratum % grid) + jitter[0]) / static_cast<float>(grid);
+    float v = (static_cast<float>(stratum / grid) + jitter[1]) / static_cast<float>(grid);
+    // L'arrondi de la division peut donner 1 : la valeur reste dans [0, 1)
+    const float below_one = 0x1.fffffep-1f;
+    return {std::min(u, below_one), std::min(v, below_one)};
+}
+
+inline sample_2d sobol_sampler::get_2d(uint64_t pixel_seed, uint32_t index,
+                                       uint32_t dimension) const {
+    uint32_t seed = sampling::hash_combine(pixel_seed, dimension);
+    uint32_t shuffled = sampling::nested_uniform_scramble(index, sampling::hash_combine(seed, 0));
+    uint32_t u = sampling::nested_uniform_scramble(sampling::reverse_bits(shuffled),
+                                                   sampling::hash_combine(seed, 1));
+    uint32_t v = sampling::nested_uniform_scramble(sampling::sobol_second_dimension(shuffled),
+                                                   sampling::hash_combine(seed, 2));
+    return {unit_float(u), unit_float(v)};
+}
+
+/** @brief Échantillonneurs disponibles en ligne de commande. */
+enum class sampler_type { independent, stratified, sobol };
+
+/**
+ * @brief Crée un échantillonneur.
+ * @param samples_per_pixel Échantillons par pixel prévus (taille de la grille stratifiée)
+ */
+inline std::shared_ptr<const sampler> make_sampler(sampler_type type, int samples_per_pixel) {
+    switch (type) {
+        case sampler_type::stratified:
+            return std::make_shared<stratified_sampler>(samples_per_pixel);
+        case sampler_type::sobol:
+            return std::make_shared<sobol_sampler>();
+        case sampler_type::independent:
+            break;
+    }
+    return std::make_shared<independent_sampler>();
+}
+
+/** @brief Lit un nom d'échantillonneur ("independent", "stratified", "sobol"). */
+inline bool parse_sampler_type(const std::string& name, sampler_type& type) {
+    if (name == "independent") {
+        type = sampler_type::independent;
+    } else if (name == "stratified") {
+        type = sampler_type::stratified;
+    } else if (name == "sobol") {
+        type = sampler_type::sobol;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Échantillon en cours sur le thread : échantillonneur, pixel, rang et prochaine
+ * dimension à tirer.
+ */
+struct sample_stream {
+    const sampler* source = nullptr;  // nullptr : `independent_sampler`
+    uint64_t pixel_seed = 0;
+    uint32_t index = 0;
+    uint32_t dimension = 0;
+};
+
+/**
+ * @brief État aléatoire complet d'un échantillon, sauvegardé quand plusieurs chemins
+ * avancent en alternance sur un même thread (paquets, mode wavefront).
+ */
+struct sample_state {
+    pcg32 generator;
+    sample_stream stream;
+};
+
+inline sample_stream& current_sample_stream() {
+    thread_local sample_stream stream;
+    return stream;
+}
+
+/**
+ * @brief Ouvre l'échantillon `index` d'un pixel : les dimensions repartent de 0.
+ * @param source Échantillonneur, nullptr pour des tirages indépendants
+ */
+inline void start_sample(const sampler* source, uint64_t pixel_seed, uint32_t index) {
+    current_sample_stream() = {source, pixel_seed, index, 0};
+}
+
+/** @brief Deux dimensions suivantes de l'échantillon courant. */
+inline sample_2d next_2d() {
+    static const independent_sampler independent;
+    sample_stream& stream = current_sample_stream();
+    const sampler& source = stream.source ? *stream.source : independent;
+    sample_2d sample = source.get_2d(stream.pixel_seed, stream.index, stream.dimension);
+    stream.dimension += 2;
+    return sample;
+}
+
+inline sample_state save_sample_state() {
+    return {random_generator(), current_sample_stream()};
+}
+
+inline void restore_sample_state(const sample_state& state) {
+    random_generator() = state.generator;
+    current_sample_stream() = state.stream;
+}
+
+/** @brief Direction uniforme sur la sphère unité, tirée de deux dimensions. */
+inline vector3 sample_unit_vector() {
+    sample_2d sample = next_2d();
+    float z = 1.0f - 2.0f * sample.u;
+    float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    float phi = static_cast<float>(2.0 * pi) * sample.v;
+    return vector3(r * std::cos(phi), r * std::sin(phi), z);
+}
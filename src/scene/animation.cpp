@@ -0,0 +1,161 @@
+#include "animation.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+vector3 read_vector(const json& value) {
+    return vector3(value[0].get<float>(), value[1].get<float>(), value[2].get<float>());
+}
+
+// Clés encadrant `frame` et poids de la seconde ; tenues hors de la plage des clés
+template <typename Keyframe>
+void bracket(const std::vector<Keyframe>& keys, int frame, const Keyframe*& a, const Keyframe*& b,
+             float& t) {
+    auto next = std::upper_bound(keys.begin(), keys.end(), frame,
+                                 [](int f, const Keyframe& key) { return f < key.frame; });
+    if (next == keys.begin()) {
+        a = b = &keys.front();
+    } else if (next == keys.end()) {
+        a = b = &keys.back();
+    } else {
+        a = &*(next - 1);
+        b = &*next;
+    }
+    t = b->frame > a->frame ? static_cast<float>(frame - a->frame) / (b->frame - a->frame) : 0.0f;
+}
+
+template <typename Keyframe>
+void sort_by_frame(std::vector<Keyframe>& keys) {
+    std::stable_sort(keys.begin(), keys.end(),
+                     [](const Keyframe& x, const Keyframe& y) { return x.frame < y.frame; });
+}
+
+}  // namespace
+
+void animation::place_camera(int frame, camera& cam) const {
+    if (camera_path.empty()) {
+        return;
+    }
+    const camera_keyframe* a;
+    const camera_keyframe* b;
+    float t;
+    bracket(camera_path, frame, a, b, t);
+
+    point3 origin = (1.0f - t) * a->origin + t * b->origin;
+    point3 look_at = (1.0f - t) * a->look_at + t * b->look_at;
+    cam.camera_origin = origin;
+    cam.view_direction = look_at - origin;
+    // Origine et cible, interpolées séparément, peuvent se croiser entre deux clés
+    // valides : la direction de la clé précédente est alors gardée
+    if (cam.view_direction.near_zero()) {
+        cam.view_direction = a->look_at - a->origin;
+    }
+    if (a->vfov > 0.0f) {
+        cam.vfov = (1.0f - t) * a->vfov + t * b->vfov;
+    }
+}
+
+std::vector<scene_session::object_offset> animation::object_offsets(int frame) const {
+    std::vector<scene_session::object_offset> offsets;
+    for (const auto& [id, keys] : object_tracks) {
+        if (keys.empty()) {
+            continue;
+        }
+        const object_keyframe* a;
+        const object_keyframe* b;
+        float t;
+        bracket(keys, frame, a, b, t);
+        offsets.push_back({id, (1.0f - t) * a->offset + t * b->offset});
+    }
+    return offsets;
+}
+
+std::string frame_filename(const std::string& pattern, int frame) {
+    std::string number = std::to_string(frame);
+    size_t first = pattern.find('#');
+    if (first == std::string::npos) {
+        number.insert(0, number.size() < 4 ? 4 - number.size() : 0, '0');
+        size_t dot = pattern.rfind('.');
+        size_t slash = pattern.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return pattern + "_" + number;
+        }
+        return pattern.substr(0, dot) + "_" + number + pattern.substr(dot);
+    }
+    size_t last = pattern.find_first_not_of('#', first);
+    size_t width = (last == std::string::npos ? pattern.size() : last) - first;
+    number.insert(0, number.size() < width ? width - number.size() : 0, '0');
+    return pattern.substr(0, first) + number + pattern.substr(first + width);
+}
+
+bool load_animation(const std::string& filename, animation& result) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open animation file: " << filename << std::endl;
+        return false;
+    }
+
+    animation loaded;
+    try {
+        json j;
+        file >> j;
+        loaded.frame_count = j.value("frames", 1);
+
+        json path_keys = j.value("camera", json::array());
+        for (const auto& key : path_keys) {
+            camera_keyframe keyframe;
+            keyframe.frame = key.value("frame", 0);
+            keyframe.origin = read_vector(key.at("origin"));
+            keyframe.look_at = key.contains("look_at")
+                                   ? read_vector(key["look_at"])
+                                   : keyframe.origin + vector3(0, 0, -1);
+            keyframe.vfov = key.value("vfov", 0.0f);
+            // Sans direction de visée, la base de la caméra n'est pas définie
+            if ((keyframe.look_at - keyframe.origin).near_zero()) {
+                std::cerr << "Camera key at frame " << keyframe.frame
+                          << ": look_at equals origin" << std::endl;
+                return false;
+            }
+            loaded.camera_path.push_back(keyframe);
+        }
+        sort_by_frame(loaded.camera_path);
+
+        // Champ manquant : celui de la clé précédente, sinon de la suivante
+        auto& path = loaded.camera_path;
+        for (size_t i = 1; i < path.size(); ++i) {
+            if (path[i].vfov <= 0.0f) {
+                path[i].vfov = path[i - 1].vfov;
+            }
+        }
+        for (size_t i = path.size(); i-- > 1;) {
+            if (path[i - 1].vfov <= 0.0f) {
+                path[i - 1].vfov = path[i].vfov;
+            }
+        }
+
+        json tracks = j.value("objects", json::object());
+        for (const auto& [id, keys] : tracks.items()) {
+            auto& track = loaded.object_tracks[id];
+            for (const auto& key : keys) {
+                track.push_back({key.value("frame", 0), read_vector(key.at("offset"))});
+            }
+            sort_by_frame(track);
+        }
+    } catch (const json::exception& e) {
+        std::cerr << "Animation parse error: " << e.what() << std::endl;
+        return false;
+    }
+
+    if (loaded.frame_count < 1) {
+        std::cerr << "Invalid frame count: " << loaded.frame_count << std::endl;
+        return false;
+    }
+    result = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/camera.hpp"
+#include "scene.hpp"
+
+/**
+ * @file animation.hpp
+ * @brief Séquences animées : trajectoire de la caméra et déplacements d'objets par image.
+ *
+ * Format JSON :
+ * @code
+ * {
+ *   "frames": 48,
+ *   "camera": [
+ *     { "frame": 0, "origin": [0, 0, 0], "look_at": [0, 0, -3], "vfov": 45 },
+ *     { "frame": 47, "origin": [2, 1, 0], "look_at": [0, 0, -3] }
+ *   ],
+ *   "objects": {
+ *     "ball": [ { "frame": 0, "offset": [0, 0, 0] }, { "frame": 47, "offset": [0, 1, 0] } ]
+ *   }
+ * }
+ * @endcode
+ *
+ * Les clés sont interpolées linéairement et tenues avant la première et après la
+ * dernière. Sans "look_at", la caméra vise -z ; sans "vfov", une clé reprend le champ
+ * de la clé voisine (celui de la caméra si aucune clé n'en donne). Les objets sont
+ * désignés par leur "id" dans la scène et déplacés depuis leur position du fichier.
+ */
+
+/** @brief Position de la caméra à une image clé. */
+struct camera_keyframe {
+    int frame = 0;
+    point3 origin = point3(0, 0, 0);
+    point3 look_at = point3(0, 0, -1);
+    float vfov = 0.0f;  // 0 : champ de la caméra inchangé
+};
+
+/** @brief Déplacement d'un objet à une image clé. */
+struct object_keyframe {
+    int frame = 0;
+    vector3 offset = vector3(0, 0, 0);
+};
+
+/** @brief Animation d'une séquence, interpolée image par image. */
+struct animation {
+    int frame_count = 1;
+    std::vector<camera_keyframe> camera_path;  // Triées par image
+    std::map<std::string, std::vector<object_keyframe>> object_tracks;  // Par "id", triées
+
+    /** @brief Place `cam` à l'image `frame` ; sans trajectoire, la caméra reste en place. */
+    void place_camera(int frame, camera& cam) const;
+
+    /** @brief Déplacement de chaque objet animé à l'image `frame`. */
+    std::vector<scene_session::object_offset> object_offsets(int frame) const;
+};
+
+/**
+ * @brief Lit une animation au format JSON.
+ *
+ * Une clé de caméra dont "look_at" est confondu avec "origin" est refusée.
+ * @return true si le fichier a été lu ; les erreurs sont signalées sur std::cerr
+ */
+bool load_animation(const std::string& filename, animation& result);
+
+/**
+ * @brief Nom de l'image `frame` d'une séquence : les '#' du motif reçoivent le numéro,
+ * complété par des zéros ; sans '#', le numéro sur 4 chiffres est ajouté avant l'extension.
+ */
+std::string frame_filename(const std::string& pattern, int frame);
@@ -1,20 +1,417 @@
 #include "scene.hpp"
 
+#include <algorithm>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <nlohmann/json.hpp>
+#include <tuple>
+#include <unordered_map>
 
+#include "core/bvh_node.hpp"
 #include "core/hitrecord.hpp"
 #include "core/hittable_list.hpp"
+#include "lib/chrono_timer.hpp"
+#include "lib/thread_pool.hpp"
 #include "material/material.hpp"
 #include "shape/cube.hpp"
+#include "shape/mesh.hpp"
 #include "shape/plane.hpp"
-#include "shape/read_mesh.hpp"
 #include "shape/sphere.hpp"
 #include "shape/triangle.hpp"
 
 using json = nlohmann::json;
 
+namespace {
+
+using mesh_table = std::unordered_map<std::string, shared_ptr<const mesh_asset>>;
+
+// Champ [x, y, z] obligatoire : absent, trop court ou mal typé, il lève json::exception
+vector3 read_vector(const json& obj, const char* key) {
+    const json& value = obj.at(key);
+    return vector3(value.at(0).get<float>(), value.at(1).get<float>(), value.at(2).get<float>());
+}
+
+/**
+ * @brief Bibliothèques nommées de la scène ("materials" et "meshes") et table des
+ * matériaux dédupliqués.
+ *
+ * Un objet référence un matériau par son nom (`"material": "rouge"`) ou le décrit en
+ * ligne ; deux matériaux de même type et de mêmes paramètres partagent la même instance,
+ * quelle que soit l'écriture de leur description. De même, un mesh peut être référencé
+ * par son nom (`"mesh": "dino"`) au lieu de son fichier.
+ */
+class scene_library {
+public:
+    void load(const json& root) {
+        // Les instances de matériaux restent en cache : un rechargement les réutilise
+        named_materials.clear();
+        named_definitions.clear();
+        named_meshes.clear();
+        if (root.contains("materials")) {
+            for (const auto& [name, m] : root["materials"].items()) {
+                named_materials[name] = create(m);
+                named_definitions[name] = m;
+            }
+        }
+        if (root.contains("meshes")) {
+            for (const auto& [name, m] : root["meshes"].items()) {
+                named_meshes[name] = m;
+            }
+        }
+    }
+
+    std::shared_ptr<material> material_for(const json& obj) {
+        if (!obj.contains("material")) {
+            return nullptr;
+        }
+
+        const auto& m = obj["material"];
+        if (m.is_string()) {
+            auto it = named_materials.find(m.get<std::string>());
+            if (it == named_materials.end()) {
+                std::cerr << "Unknown material: " << m.get<std::string>() << std::endl;
+                return nullptr;
+            }
+            return it->second;
+        }
+        return create(m);
+    }
+
+    /** @brief Description du matériau de l'objet (nommé ou en ligne), null sinon. */
+    const json& material_definition(const json& obj) const {
+        static const json none;
+        if (!obj.contains("material")) {
+            return none;
+        }
+        const auto& m = obj["material"];
+        if (m.is_string()) {
+            auto it = named_definitions.find(m.get<std::string>());
+            return it == named_definitions.end() ? none : it->second;
+        }
+        return m;
+    }
+
+    /**
+     * @brief Vrai si le mesh de l'objet est décrit par un fichier ou une entrée connue de
+     * la bibliothèque ; un nom inconnu est signalé ici, une seule fois par objet.
+     */
+    bool has_mesh(const json& obj) const {
+        if (obj.contains("mesh") && !mesh_entry(obj)) {
+            std::cerr << "Unknown mesh: " << obj["mesh"].get<std::string>() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /** @brief Entrée de bibliothèque du mesh de l'objet s'il est nommé, null sinon. */
+    const json& mesh_definition(const json& obj) const {
+        static const json none;
+        const json* entry = mesh_entry(obj);
+        return entry ? *entry : none;
+    }
+
+    std::string mesh_file(const json& obj) const {
+        if (const json* entry = mesh_entry(obj)) {
+            return entry->at("file").get<std::string>();
+        }
+        return obj.contains("mesh") ? "" : obj.value("file", "");
+    }
+
+    float mesh_scale(const json& obj) const {
+        if (obj.contains("scale")) {
+            return obj.at("scale").get<float>();
+        }
+        if (const json* entry = mesh_entry(obj)) {
+            return entry->value("scale", 1.0f);
+        }
+        return 1.0f;
+    }
+
+    size_t material_count() const {
+        return unique_materials.size();
+    }
+
+    /** @brief Oublie les matériaux que plus aucun objet ni nom n'utilise. */
+    void prune_materials() {
+        for (auto it = unique_materials.begin(); it != unique_materials.end();) {
+            it = it->second.use_count() == 1 ? unique_materials.erase(it) : std::next(it);
+        }
+    }
+
+private:
+    // Type et paramètres d'un matériau, tels qu'ils sont lus
+    using material_params = std::tuple<std::string, float, float, float>;
+
+    std::unordered_map<std::string, std::shared_ptr<material>> named_materials;
+    std::unordered_map<std::string, json> named_definitions;
+    std::map<material_params, std::shared_ptr<material>> unique_materials;
+    std::unordered_map<std::string, json> named_meshes;
+
+    const json* mesh_entry(const json& obj) const {
+        if (!obj.contains("mesh")) {
+            return nullptr;
+        }
+        auto it = named_meshes.find(obj["mesh"].get<std::string>());
+        return it == named_meshes.end() ? nullptr : &it->second;
+    }
+
+    std::shared_ptr<material> create(const json& m) {
+        std::string type = m.at("type");
+        const char* field = type == "diffuse_light" ? "emission" : "albedo";
+        material_params key(type, 0.0f, 0.0f, 0.0f);
+        if (m.contains(field)) {
+            vector3 value = read_vector(m, field);
+            key = {type, value.x(), value.y(), value.z()};
+        }
+
+        // Les paramètres lus servent de clé : ordre des champs, espaces ou écriture des
+        // nombres (1 ou 1.0) n'empêchent pas le partage
+        auto it = unique_materials.find(key);
+        if (it != unique_materials.end()) {
+            return it->second;
+        }
+
+        std::shared_ptr<material> mat;
+        color value(std::get<1>(key), std::get<2>(key), std::get<3>(key));
+        if (type == "lambertian") {
+            mat = std::make_shared<lambertian>(value);
+        } else if (type == "metal") {
+            mat = std::make_shared<metal>(value);
+        } else if (type == "diffuse_light") {
+            mat = std::make_shared<diffuse_light>(value);
+        } else {
+            std::cerr << "Unknown material type: " << type << std::endl;
+        }
+
+        unique_materials[key] = mat;
+        return mat;
+    }
+};
+
+std::shared_ptr<Hittable> make_object(const json& obj, std::shared_ptr<material> mat,
+                                      const scene_library& library, const mesh_table& meshes) {
+    std::string type = obj.at("type");
+    if (type == "sphere") {
+        auto center = read_vector(obj, "center");
+        double radius = obj.at("radius");
+        return std::make_shared<sphere>(center, radius, mat);
+    } else if (type == "cube") {
+        auto center = read_vector(obj, "center");
+        double size = obj.at("size");
+        return std::make_shared<cube>(center, size, mat);
+    } else if (type == "plane") {
+        auto point = read_vector(obj, "point");
+        auto normal = read_vector(obj, "normal");
+        return std::make_shared<plane>(point, normal, mat);
+    } else if (type == "triangle") {
+        auto v0 = read_vector(obj, "v0");
+        auto v1 = read_vector(obj, "v1");
+        auto v2 = read_vector(obj, "v2");
+        return std::make_shared<triangle>(v0, v1, v2, mat);
+    } else if (type == "mesh") {
+        auto it = meshes.find(library.mesh_file(obj));
+        if (it == meshes.end() || !it->second) {
+            return nullptr;  // Erreur déjà signalée au chargement
+        }
+        float scale = library.mesh_scale(obj);
+        if (!(scale > 0.0f)) {
+            std::cerr << "Invalid mesh scale: " << scale << std::endl;
+            return nullptr;
+        }
+        auto origin = obj.contains("origin") ? read_vector(obj, "origin") : point3(0, 0, 0);
+        return std::make_shared<mesh_instance>(it->second, mat, scale, origin);
+    } else {
+        std::cerr << "Unknown object type: " << type << std::endl;
+    }
+    return nullptr;
+}
+
+void add_object(const json& obj, std::shared_ptr<material> mat, const scene_library& library,
+                const mesh_table& meshes, hittable_list& world) {
+    if (auto object = make_object(obj, mat, library, meshes)) {
+        world.add(object);
+    }
+}
+
+/**
+ * @brief Ajoute le fichier du mesh `obj` à `paths` s'il n'y est pas encore.
+ * @return false si le mesh nommé est inconnu (signalé une fois) : l'objet est ignoré
+ */
+bool collect_mesh_path(const json& obj, const scene_library& library,
+                       std::vector<std::string>& paths) {
+    if (!library.has_mesh(obj)) {
+        return false;
+    }
+    std::string path = library.mesh_file(obj);
+    if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+        paths.push_back(path);
+    }
+    return true;
+}
+
+/**
+ * @brief Charge en parallèle chaque fichier .obj distinct (parsing + BVH du mesh).
+ *
+ * Chaque fichier est une tâche du pool partagé ; le résultat ne dépend pas de
+ * l'ordre d'exécution puisque chaque fichier a sa propre entrée. `meanwhile` est
+ * exécuté sur le thread appelant pendant le chargement. Une exception levée par un
+ * chargement est relancée une fois toutes les tâches terminées.
+ */
+mesh_table load_meshes(const std::vector<std::string>& paths,
+                       const std::function<void()>& meanwhile = nullptr) {
+    std::vector<shared_ptr<const mesh_asset>> assets(paths.size());
+
+    task_group group(thread_pool::instance());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        group.run([&assets, &paths, i] { assets[i] = mesh_cache::instance().load(paths[i]); });
+    }
+    // Les tâches écrivent dans `assets` : elles sont attendues même si `meanwhile` échoue
+    std::exception_ptr failure;
+    if (meanwhile) {
+        try {
+            meanwhile();
+        } catch (...) {
+            failure = std::current_exception();
+        }
+    }
+    group.wait();
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    mesh_table meshes;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        meshes[paths[i]] = assets[i];
+    }
+    return meshes;
+}
+
+/**
+ * @brief Handler SAX qui construit les éléments de "objects" un par un.
+ *
+ * Les clés de premier niveau autres que "objects" sont gardées dans `root` ; chaque
+ * élément du tableau "objects" est construit seul, transmis au callback dès sa fin
+ * de parsing (avec les clés de premier niveau déjà lues) puis libéré. Le DOM complet
+ * de la scène n'existe donc jamais en mémoire.
+ */
+class scene_sax_handler : public nlohmann::json_sax<json> {
+public:
+    using element_callback = std::function<void(const json& root, const json& element)>;
+
+    explicit scene_sax_handler(element_callback on_element) : on_element(on_element) {}
+
+    json root;
+
+    bool null() override {
+        return value(nullptr);
+    }
+    bool boolean(bool val) override {
+        return value(val);
+    }
+    bool number_integer(number_integer_t val) override {
+        return value(val);
+    }
+    bool number_unsigned(number_unsigned_t val) override {
+        return value(val);
+    }
+    bool number_float(number_float_t val, const string_t&) override {
+        return value(val);
+    }
+    bool string(string_t& val) override {
+        return value(std::move(val));
+    }
+    bool binary(binary_t& val) override {
+        return value(json::binary(std::move(val)));
+    }
+
+    bool start_object(std::size_t) override {
+        stack.push_back(place(json::object()));
+        return true;
+    }
+    bool key(string_t& val) override {
+        last_key = val;
+        return true;
+    }
+    bool end_object() override {
+        return close();
+    }
+
+    bool start_array(std::size_t) override {
+        // Le tableau "objects" de la racine n'est pas stocké : ses éléments sont émis
+        if (!in_objects && stack.size() == 1 && last_key == "objects") {
+            in_objects = true;
+            return true;
+        }
+        stack.push_back(place(json::array()));
+        return true;
+    }
+    bool end_array() override {
+        if (in_objects && stack.size() == 1) {
+            in_objects = false;
+            return true;
+        }
+        return close();
+    }
+
+    bool parse_error(std::size_t position, const std::string&,
+                     const nlohmann::detail::exception& ex) override {
+        std::cerr << "Scene parse error at byte " << position << ": " << ex.what() << std::endl;
+        return false;
+    }
+
+private:
+    element_callback on_element;
+    std::vector<json*> stack;
+    std::string last_key;
+    bool in_objects = false;
+    json element;
+
+    json* place(json&& val) {
+        if (stack.empty()) {
+            root = std::move(val);
+            return &root;
+        }
+        if (in_objects && stack.size() == 1) {
+            element = std::move(val);
+            return &element;
+        }
+        json& parent = *stack.back();
+        if (parent.is_array()) {
+            parent.push_back(std::move(val));
+            return &parent.back();
+        }
+        json& slot = parent[last_key];
+        slot = std::move(val);
+        return &slot;
+    }
+
+    bool value(json&& val) {
+        if (place(std::move(val)) == &element) {
+            emit();
+        }
+        return true;
+    }
+
+    bool close() {
+        json* closed = stack.back();
+        stack.pop_back();
+        if (closed == &element) {
+            emit();
+        }
+        return true;
+    }
+
+    void emit() {
+        on_element(root, element);
+        element = json();
+    }
+};
+
+}  // namespace
+
 void load_scene_from_json_file(const std::string& filename, hittable_list& world) {
     std::ifstream file(filename);
     if (!file.is_open()) {
@@ -22,56 +419,460 @@ void load_scene_from_json_file(const std::string& filename, hittable_list& world
         return;
     }
 
+    Chrono total_timer;
+    total_timer.start();
+
+    // Objets construits à part : un fichier invalide (champ obligatoire absent ou mal typé)
+    // est signalé et ne laisse rien dans `world`
+    hittable_list loaded;
+    try {
+        // 1. Parsing du JSON
+        Chrono stage_timer;
+        stage_timer.start();
+        json j;
+        file >> j;
+        const json& objects = j.at("objects");
+        scene_library library;
+        library.load(j);
+        stage_timer.log("Scene: parsing JSON");
+
+        // 2. Meshes et matériaux en parallèle
+        stage_timer.start();
+        std::vector<std::string> mesh_paths;
+        for (const auto& obj : objects) {
+            if (obj.at("type") == "mesh") {
+                collect_mesh_path(obj, library, mesh_paths);
+            }
+        }
+
+        // Les matériaux sont créés par le thread appelant pendant que le pool charge les
+        // meshes : seul ce thread modifie la table des matériaux
+        std::vector<std::shared_ptr<material>> materials(objects.size());
+        mesh_table meshes = load_meshes(mesh_paths, [&]() {
+            for (size_t i = 0; i < objects.size(); ++i) {
+                materials[i] = library.material_for(objects[i]);
+            }
+        });
+        stage_timer.log("Scene: meshes (" + std::to_string(mesh_paths.size()) +
+                        " fichiers) et " + std::to_string(library.material_count()) +
+                        " materiaux");
+
+        // 3. Assemblage dans l'ordre du fichier : indépendant du nombre de threads
+        stage_timer.start();
+        for (size_t i = 0; i < objects.size(); ++i) {
+            add_object(objects[i], materials[i], library, meshes, loaded);
+        }
+        stage_timer.log("Scene: assemblage");
+    } catch (const json::exception& e) {
+        std::cerr << "Scene not loaded: " << filename << ": " << e.what() << std::endl;
+        return;
+    }
+    for (const auto& object : loaded.objects) {
+        world.add(object);
+    }
+
+    total_timer.log("Scene: chargement total");
+}
+
+void stream_scene_from_json_file(const std::string& filename, hittable_list& world) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open scene file: " << filename << std::endl;
+        return;
+    }
+
+    Chrono total_timer;
+    total_timer.start();
+
+    // 1. Parsing et création des primitives au fil de l'eau
+    Chrono stage_timer;
+    stage_timer.start();
+    // Objets construits à part : une erreur de parsing ne laisse rien dans `world`
+    hittable_list parsed;
+    std::vector<json> pending_meshes;
+    std::vector<std::shared_ptr<material>> mesh_materials;
+    std::vector<std::string> mesh_paths;
+    const mesh_table no_meshes;
+    scene_library library;
+    bool library_loaded = false;
+
+    scene_sax_handler handler([&](const json& root, const json& obj) {
+        // Les bibliothèques doivent précéder "objects" dans le fichier
+        if (!library_loaded) {
+            library.load(root);
+            library_loaded = true;
+        }
+        if (!obj.is_object()) {
+            return;
+        }
+        if (obj.at("type") == "mesh") {
+            // Les fichiers .obj sont chargés en parallèle une fois le parsing terminé
+            if (!collect_mesh_path(obj, library, mesh_paths)) {
+                return;
+            }
+            mesh_materials.push_back(library.material_for(obj));
+            pending_meshes.push_back(obj);
+            return;
+        }
+        add_object(obj, library.material_for(obj), library, no_meshes, parsed);
+    });
+
+    try {
+        if (!json::sax_parse(file, &handler)) {
+            std::cerr << "Scene not loaded: " << filename << std::endl;
+            return;
+        }
+        stage_timer.log("Scene (streaming): parsing et primitives");
+
+        // 2. Meshes
+        stage_timer.start();
+        mesh_table meshes = load_meshes(mesh_paths);
+        for (size_t i = 0; i < pending_meshes.size(); ++i) {
+            add_object(pending_meshes[i], mesh_materials[i], library, meshes, parsed);
+        }
+    } catch (const json::exception& e) {
+        // Champ obligatoire absent ou mal typé dans un objet
+        std::cerr << "Scene not loaded: " << filename << ": " << e.what() << std::endl;
+        return;
+    }
+    for (const auto& object : parsed.objects) {
+        world.add(object);
+    }
+    stage_timer.log("Scene (streaming): meshes (" + std::to_string(mesh_paths.size()) +
+                    " fichiers)");
+
+    total_timer.log("Scene (streaming): chargement total");
+}
+
+struct scene_session::state {
+    struct entry {
+        // Ce dont l'objet a été construit : comparé tel quel au rechargement suivant
+        json description;
+        json material;
+        json mesh;
+        shared_ptr<const mesh_asset> asset;
+        std::shared_ptr<Hittable> object;
+        bool stable = false;  // Dans `stable_bvh`
+    };
+
+    scene_library library;
+    std::unordered_map<std::string, entry> objects;
+    std::vector<std::string> keys;  // Clé de chaque objet, dans l'ordre du fichier
+    std::vector<std::string> mesh_paths;
+    json descriptions;  // "objects" du dernier fichier lu, positions d'origine
+    mesh_table meshes;  // Meshes du dernier fichier lu
+
+    // Séquences animées : indices des objets de chaque "id", et déplacement appliqué à
+    // chaque "id" depuis le dernier fichier lu (absent : position d'origine)
+    std::unordered_map<std::string, std::vector<size_t>> indices_by_id;
+    std::unordered_map<std::string, vector3> applied_offsets;
+
+    // BVH de premier niveau en deux parties : les objets restés intacts depuis sa
+    // construction, et les objets (re)construits depuis, souvent ceux qui changeront
+    // encore. Tant qu'aucun objet stable ne disparaît, seule la seconde est refaite
+    shared_ptr<Hittable> stable_bvh;
+    size_t stable_count = 0;
+
+    // Met à jour les objets d'après leurs descriptions, avec la bibliothèque et les meshes
+    // du fichier relu : seuls les objets nouveaux ou modifiés sont reconstruits. Ils le
+    // sont avant de toucher à l'état : une description invalide lève json::exception et
+    // laisse la session et `world` inchangés. Si un objet a changé, `world` est refait
+    void update(const json& objects_json, scene_library next_library, mesh_table next_meshes,
+                reload_stats& next_stats, hittable_list& world);
+
+    // Remplace la description des objets d'indices donnés et ne reconstruit qu'eux, sans
+    // repasser sur les autres descriptions
+    void move(const std::vector<std::pair<size_t, json>>& moved, reload_stats& next_stats,
+              hittable_list& world);
+
+    // Refait `world` : objets dans l'ordre du fichier, marqués s'ils viennent d'être
+    // reconstruits ; `stable_kept` objets stables sont restés intacts
+    void assemble(const std::vector<std::pair<std::string, bool>>& order, size_t stable_kept,
+                  bool all_created, hittable_list& world);
+};
+
+void scene_session::state::update(const json& objects_json, scene_library next_library,
+                                  mesh_table next_meshes, reload_stats& next_stats,
+                                  hittable_list& world) {
+    // 1. Objets nouveaux ou modifiés, dans l'ordre du fichier : seule étape qui peut lever
+    std::unordered_map<std::string, int> occurrences;
+    // Objets dans l'ordre du fichier, avec leur clé et le fait d'avoir été reconstruits
+    std::vector<std::pair<std::string, bool>> order;
+    std::vector<entry> created_entries;
+    size_t replaced = 0;  // Clé connue, objet reconstruit
+    for (const auto& obj : objects_json) {
+        // Sans "id", le contenu identifie l'objet ; la description est comparée ensuite
+        std::string key = obj.contains("id") ? "id:" + obj["id"].dump()
+                                             : "hash:" + std::to_string(std::hash<json>{}(obj));
+        key += "#" + std::to_string(occurrences[key]++);
+
+        const json& material = next_library.material_definition(obj);
+        const json& mesh = next_library.mesh_definition(obj);
+        shared_ptr<const mesh_asset> asset;
+        if (obj.at("type") == "mesh") {
+            auto it = next_meshes.find(next_library.mesh_file(obj));
+            asset = it != next_meshes.end() ? it->second : nullptr;
+        }
+
+        auto previous = objects.find(key);
+        if (previous != objects.end() && previous->second.asset == asset &&
+            previous->second.description == obj && previous->second.material == material &&
+            previous->second.mesh == mesh) {
+            order.emplace_back(key, false);
+            continue;
+        }
+        replaced += previous != objects.end() ? 1 : 0;
+        created_entries.push_back(
+            {obj, material, mesh, asset,
+             make_object(obj, next_library.material_for(obj), next_library, next_meshes)});
+        order.emplace_back(key, true);
+    }
+
+    // 2. Nouvel état : objets réutilisés repris de l'ancien, bibliothèque et meshes du
+    // fichier relu
+    std::unordered_map<std::string, entry> next_objects;
+    size_t stable_kept = 0;
+    auto created_entry = created_entries.begin();
+    for (const auto& [key, created] : order) {
+        entry& next = next_objects[key];
+        if (created) {
+            next = std::move(*created_entry++);
+            next_stats.created++;
+        } else {
+            next = std::move(objects[key]);
+            next_stats.reused++;
+            stable_kept += next.stable && next.object ? 1 : 0;
+        }
+    }
+
+    next_stats.removed = objects.size() - next_stats.reused - replaced;
+    objects = std::move(next_objects);
+    library = std::move(next_library);
+    meshes = std::move(next_meshes);
+    keys.clear();
+    for (const auto& [key, created] : order) {
+        keys.push_back(key);
+    }
+    library.prune_materials();
+    if (next_stats.created == 0 && next_stats.removed == 0) {
+        return;
+    }
+    assemble(order, stable_kept, next_stats.reused == 0, world);
+}
+
+void scene_session::state::move(const std::vector<std::pair<size_t, json>>& moved,
+                                reload_stats& next_stats, hittable_list& world) {
+    std::vector<std::pair<std::string, bool>> order;
+    for (const auto& key : keys) {
+        order.emplace_back(key, false);
+    }
+    size_t stable_moved = 0;
+    for (const auto& [index, description] : moved) {
+        entry& e = objects[keys[index]];
+        if (e.description == description) {
+            continue;
+        }
+        stable_moved += e.stable && e.object ? 1 : 0;
+        e.description = description;
+        e.object = make_object(description, library.material_for(description), library, meshes);
+        order[index].second = true;
+        next_stats.created++;
+    }
+    next_stats.reused = keys.size() - next_stats.created;
+    if (next_stats.created > 0) {
+        assemble(order, stable_count - stable_moved, false, world);
+    }
+}
+
+void scene_session::state::assemble(const std::vector<std::pair<std::string, bool>>& order,
+                                    size_t stable_kept, bool all_created, hittable_list& world) {
+    // Un objet stable a disparu, ou la partie récente dépasse la partie stable : les
+    // objets réutilisés deviennent stables (tous, s'il n'y en a aucun)
+    size_t recent_count = order.size() - stable_kept;
+    bool rebuild_stable = !stable_bvh || stable_kept != stable_count || recent_count > stable_count;
+    hittable_list stable_list;
+    hittable_list recent_list;
+    for (const auto& [key, created] : order) {
+        entry& e = objects[key];
+        if (rebuild_stable) {
+            e.stable = !created || all_created;
+        }
+        if (e.object) {
+            (e.stable ? stable_list : recent_list).add(e.object);
+        }
+    }
+
+    if (rebuild_stable) {
+        stable_count = stable_list.objects.size();
+        stable_bvh = stable_list.objects.empty()
+                         ? nullptr
+                         : std::make_shared<bvh_node>(stable_list, &thread_pool::instance());
+    }
+    world = hittable_list();
+    if (stable_bvh) {
+        world.add(stable_bvh);
+    }
+    if (!recent_list.objects.empty()) {
+        world.add(std::make_shared<bvh_node>(recent_list, &thread_pool::instance()));
+    }
+}
+
+namespace {
+
+// Description d'un objet translatée de `offset` : origine d'un mesh, centre, point ou
+// sommets des autres primitives
+json translated(const json& obj, const vector3& offset) {
+    json moved = obj;
+    auto shift = [&moved, &offset](const char* key) {
+        if (moved.contains(key)) {
+            for (int i = 0; i < 3; ++i) {
+                moved[key][i] = moved[key][i].get<double>() + offset[i];
+            }
+        }
+    };
+    if (obj.at("type") == "mesh") {
+        if (!moved.contains("origin")) {
+            moved["origin"] = {0, 0, 0};
+        }
+        shift("origin");
+    } else {
+        for (const char* key : {"center", "point", "v0", "v1", "v2"}) {
+            shift(key);
+        }
+    }
+    return moved;
+}
+
+bool same_offset(const vector3& a, const vector3& b) {
+    return a.x() == b.x() && a.y() == b.y() && a.z() == b.z();
+}
+
+// "id" d'un objet sous forme de texte : la chaîne elle-même, ou le nombre écrit
+std::string object_id(const json& obj) {
+    if (!obj.contains("id")) {
+        return "";
+    }
+    return obj["id"].is_string() ? obj["id"].get<std::string>() : obj["id"].dump();
+}
+
+}  // namespace
+
+scene_session::scene_session() : current(std::make_unique<state>()) {}
+
+scene_session::~scene_session() = default;
+
+scene_session::reload_status scene_session::reload(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open scene file: " << filename << std::endl;
+        return reload_status::failed;
+    }
+    scene_file = filename;
+
+    Chrono reload_timer;
+    reload_timer.start();
+
+    // Un fichier en cours d'écriture ou invalide ne doit pas interrompre le mode watch : la
+    // bibliothèque est relue dans une copie, et l'état n'est modifié que si tout est valide
     json j;
-    file >> j;
-
-    for (auto& obj : j["objects"]) {
-        std::shared_ptr<material> mat = nullptr;
-
-        // Create material
-        if (obj.contains("material")) {
-            auto m = obj["material"];
-            std::string type = m["type"];
-            if (type == "lambertian") {
-                mat = std::make_shared<lambertian>(
-                    color(m["albedo"][0], m["albedo"][1], m["albedo"][2]));
-            } else if (type == "metal") {
-                mat =
-                    std::make_shared<metal>(color(m["albedo"][0], m["albedo"][1], m["albedo"][2]));
-            } else {
-                std::cerr << "Unknown material type: " << type << std::endl;
+    reload_stats next_stats;
+    try {
+        file >> j;
+        const json& objects = j.at("objects");
+        scene_library library = current->library;
+        library.load(j);
+
+        // Les fichiers inchangés sont servis par le cache ; un fichier modifié est relu
+        std::vector<std::string> mesh_paths;
+        for (const auto& obj : objects) {
+            if (obj.at("type") == "mesh") {
+                collect_mesh_path(obj, library, mesh_paths);
             }
         }
+        mesh_table meshes = load_meshes(mesh_paths);
+
+        current->update(objects, std::move(library), std::move(meshes), next_stats, world);
+        current->mesh_paths = mesh_paths;
+    } catch (const json::exception& e) {
+        std::cerr << "Scene not loaded: " << filename << ": " << e.what() << std::endl;
+        return reload_status::failed;
+    }
+    current->descriptions = std::move(j.at("objects"));
+    current->indices_by_id.clear();
+    for (size_t i = 0; i < current->descriptions.size(); ++i) {
+        std::string id = object_id(current->descriptions[i]);
+        if (!id.empty()) {
+            current->indices_by_id[id].push_back(i);
+        }
+    }
+    current->applied_offsets.clear();  // Objets revenus aux positions du fichier
+    stats = next_stats;
+
+    std::cout << "Scene reload: " << stats.reused << " reutilises, " << stats.created
+              << " crees, " << stats.removed << " supprimes" << std::endl;
+    if (stats.created == 0 && stats.removed == 0) {
+        reload_timer.log("Scene reload: inchangee");
+        return reload_status::unchanged;
+    }
+    reload_timer.log("Scene reload");
+    return reload_status::changed;
+}
 
-        // Create object
-        std::string type = obj["type"];
-        if (type == "sphere") {
-            auto center = point3(obj["center"][0], obj["center"][1], obj["center"][2]);
-            double radius = obj["radius"];
-            world.add(std::make_shared<sphere>(center, radius, mat));
-        } else if (type == "cube") {
-            auto center = point3(obj["center"][0], obj["center"][1], obj["center"][2]);
-            double size = obj["size"];
-            world.add(std::make_shared<cube>(center, size, mat));
-        } else if (type == "plane") {
-            auto point = point3(obj["point"][0], obj["point"][1], obj["point"][2]);
-            auto normal = vector3(obj["normal"][0], obj["normal"][1], obj["normal"][2]);
-            world.add(std::make_shared<plane>(point, normal, mat));
-        } else if (type == "triangle") {
-            auto v0 = point3(obj["v0"][0], obj["v0"][1], obj["v0"][2]);
-            auto v1 = point3(obj["v1"][0], obj["v1"][1], obj["v1"][2]);
-            auto v2 = point3(obj["v2"][0], obj["v2"][1], obj["v2"][2]);
-            world.add(std::make_shared<triangle>(v0, v1, v2, mat));
-        } else if (type == "mesh") {
-            std::string filepath = obj["file"];
-            float scale = obj.value("scale", 1.0f);
-            auto origin = obj.contains("origin")
-                              ? point3(obj["origin"][0], obj["origin"][1], obj["origin"][2])
-                              : point3(0, 0, 0);
-            read_mesh mesh_loader(filepath, &world, mat, scale, origin);
-            mesh_loader.add_mesh();
+bool scene_session::apply_offsets(const std::vector<object_offset>& offsets) {
+    Chrono update_timer;
+    update_timer.start();
+
+    // Déplacement de chaque "id" à cette image ; pour un même "id", le premier l'emporte
+    std::unordered_map<std::string, vector3> next_offsets;
+    for (const auto& offset : offsets) {
+        if (current->indices_by_id.count(offset.id) == 0) {
+            std::cerr << "Unknown object id: " << offset.id << std::endl;
         } else {
-            std::cerr << "Unknown object type: " << type << std::endl;
+            next_offsets.emplace(offset.id, offset.offset);
+        }
+    }
+
+    // Seuls les "id" dont le déplacement diffère de l'image précédente sont touchés ; un
+    // objet qui n'est plus animé revient à sa description d'origine
+    const vector3 none(0, 0, 0);
+    std::vector<std::pair<size_t, json>> moved;
+    auto move = [&](const std::string& id, const vector3& offset) {
+        for (size_t index : current->indices_by_id[id]) {
+            const json& original = current->descriptions[index];
+            moved.emplace_back(index, same_offset(offset, none) ? original
+                                                                : translated(original, offset));
+        }
+    };
+    for (const auto& [id, offset] : next_offsets) {
+        auto previous = current->applied_offsets.find(id);
+        if (!same_offset(offset, previous != current->applied_offsets.end() ? previous->second
+                                                                             : none)) {
+            move(id, offset);
         }
     }
+    for (const auto& [id, offset] : current->applied_offsets) {
+        if (next_offsets.count(id) == 0 && !same_offset(offset, none)) {
+            move(id, none);
+        }
+    }
+    current->applied_offsets = std::move(next_offsets);
+
+    // Les objets immobiles et les BVH des meshes sont conservés ; seule la partie du BVH
+    // de premier niveau qui contient les objets déplacés est refaite
+    reload_stats next_stats;
+    current->move(moved, next_stats, world);
+    stats = next_stats;
+    if (stats.created == 0 && stats.removed == 0) {
+        return false;
+    }
+    update_timer.log("Scene update: " + std::to_string(stats.created) + " objet(s) deplace(s)");
+    return true;
+}
+
+std::vector<std::string> scene_session::watched_files() const {
+    std::vector<std::string> files = current->mesh_paths;
+    if (!scene_file.empty()) {
+        files.insert(files.begin(), scene_file);
+    }
+    return files;
 }
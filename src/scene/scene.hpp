@@ -6,5 +6,115 @@
 
 #include "core/hittable.hpp"
 #include "core/hittable_list.hpp"
+#include "maths/vector3.hpp"
 
+/**
+ * @brief Charge une scène décrite en JSON et ajoute ses objets à `world`.
+ *
+ * Les clés optionnelles "materials" et "meshes" déclarent des bibliothèques nommées :
+ * un objet peut alors écrire `"material": "nom"` et, pour un mesh, `"mesh": "nom"` à
+ * la place de `"file"`. Les matériaux identiques (nommés ou en ligne) sont dédupliqués
+ * et partagent une seule instance.
+ *
+ * Le chargement se fait en trois étapes chronométrées : parsing du JSON, chargement
+ * des fichiers .obj distincts (avec leur BVH) en parallèle sur le pool partagé pendant
+ * que le thread appelant crée les matériaux, puis assemblage dans l'ordre du fichier.
+ * Le résultat est identique quel que soit le nombre de threads ; une exception levée
+ * par le chargement d'un mesh est relancée par cette fonction.
+ *
+ * @param filename Chemin du fichier de scène
+ * @param world Liste dans laquelle les objets sont ajoutés
+ */
 void load_scene_from_json_file(const std::string& filename, hittable_list& world);
+
+/**
+ * @brief Variante streaming de `load_scene_from_json_file` pour les très grosses scènes.
+ *
+ * Le fichier est lu via l'interface SAX de nlohmann::json : chaque élément de
+ * "objects" est transformé en primitive dès qu'il est parsé, sans construire le DOM
+ * complet. La mémoire maximale est donc bornée par la géométrie elle-même. Les
+ * meshes sont chargés en parallèle à la fin du parsing et ajoutés après les autres
+ * objets. Les bibliothèques "materials" et "meshes" doivent précéder "objects" dans le
+ * fichier. Sur une erreur de parsing, l'erreur est signalée et `world` reste inchangé,
+ * même si des objets valides précédaient l'erreur.
+ *
+ * @param filename Chemin du fichier de scène
+ * @param world Liste dans laquelle les objets sont ajoutés
+ */
+void stream_scene_from_json_file(const std::string& filename, hittable_list& world);
+
+/**
+ * @brief Scène rechargeable à chaud, utilisée par le mode watch.
+ *
+ * Chaque objet est identifié par son champ "id" s'il existe, sinon par son contenu.
+ * À chaque `reload`, seuls les objets nouveaux ou modifiés (description, matériau
+ * résolu ou fichier .obj changé sur disque) sont reconstruits ; les autres, ainsi
+ * que les matériaux et les meshes (BVH compris), sont réutilisés tels quels.
+ *
+ * Le BVH de premier niveau est en deux parties : les objets intacts depuis sa
+ * construction et ceux reconstruits depuis. Modifier à nouveau un objet déjà modifié
+ * ne refait que la seconde ; la première n'est refaite que lorsqu'un de ses objets
+ * change ou que la seconde devient la plus grande. Le fichier JSON, lui, est relu en
+ * entier à chaque rechargement.
+ */
+class scene_session {
+public:
+    /** @brief Déplacement d'un objet, désigné par son "id", depuis sa position du fichier. */
+    struct object_offset {
+        std::string id;
+        vector3 offset;
+    };
+
+    struct reload_stats {
+        size_t reused = 0;
+        size_t created = 0;
+        size_t removed = 0;
+    };
+
+    /** @brief Résultat d'un rechargement. */
+    enum class reload_status {
+        changed,    // Le monde a changé et doit être re-rendu
+        unchanged,  // Fichier relu, aucun objet modifié
+        failed,     // Fichier illisible ou invalide : le monde précédent est gardé
+    };
+
+    scene_session();
+    ~scene_session();
+
+    /**
+     * @brief Relit le fichier de scène et met à jour le monde de façon incrémentale.
+     * @param filename Chemin du fichier de scène
+     * @return `changed` si le monde doit être re-rendu, `failed` si le fichier n'a pas
+     * pu être lu (erreur signalée sur std::cerr)
+     */
+    reload_status reload(const std::string& filename);
+
+    /**
+     * @brief Déplace des objets par rapport à leur position dans le dernier fichier lu.
+     *
+     * Les objets absents de `offsets` reprennent leur position d'origine. Seuls les objets
+     * dont la position change depuis l'appel précédent sont recréés ; un mesh déplacé
+     * garde son BVH, seule son origine change. Utilisé par les séquences animées.
+     * @return true si le monde a changé
+     */
+    bool apply_offsets(const std::vector<object_offset>& offsets);
+
+    /** @brief Le monde courant, avec son BVH de premier niveau. */
+    const hittable_list& get_world() const {
+        return world;
+    }
+
+    const reload_stats& get_stats() const {
+        return stats;
+    }
+
+    /** @brief Fichiers dont la modification doit déclencher un rechargement. */
+    std::vector<std::string> watched_files() const;
+
+private:
+    struct state;
+    std::unique_ptr<state> current;
+    std::string scene_file;
+    hittable_list world;
+    reload_stats stats;
+};
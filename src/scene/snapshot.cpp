@@ -0,0 +1,745 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "core/hitrecord.hpp"
+#include "core/light.hpp"
+#include "lib/thread_pool.hpp"
+#include "material/material.hpp"
+#include "shape/cube.hpp"
+#include "shape/mesh.hpp"
+#include "shape/plane.hpp"
+#include "shape/sphere.hpp"
+#include "shape/triangle.hpp"
+
+namespace {
+
+constexpr char snapshot_magic[8] = {'R', 'A', 'Y', 'B', 'S', 'N', 'A', 'P'};
+constexpr uint32_t snapshot_version = 1;
+constexpr uint32_t no_material = 0xffffffffu;
+// Taille des piles de parcours ; les arbres plus profonds sont refusés au chargement
+constexpr int max_tree_depth = 64;
+
+enum snapshot_material_type : uint32_t {
+    material_lambertian = 0,
+    material_metal = 1,
+    material_diffuse_light = 2,  // `albedo` contient l'émission
+};
+
+enum snapshot_primitive_type : uint32_t {
+    primitive_sphere = 0,    // data : centre (3), rayon
+    primitive_triangle = 1,  // data : v0 (3), v1 (3), v2 (3), normale (3)
+    primitive_plane = 2,     // data : point (3), normale (3)
+};
+
+struct snapshot_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t material_count;
+    uint32_t primitive_count;
+    uint32_t unbounded_count;
+    uint32_t node_count;
+    uint32_t reserved;
+    uint64_t checksum;
+};
+
+struct snapshot_material {
+    uint32_t type;
+    float albedo[3];
+};
+
+struct snapshot_primitive {
+    uint32_t type;
+    uint32_t material;
+    float data[12];
+};
+
+/**
+ * Noeud du BVH aplati. Noeud interne (count == 0) : l'enfant gauche suit directement
+ * le noeud, `offset` est l'indice de l'enfant droit. Feuille : primitives
+ * [offset, offset + count).
+ */
+struct snapshot_node {
+    aabb box;
+    uint32_t offset;
+    uint32_t count;
+};
+
+static_assert(std::is_trivially_copyable<aabb>::value, "aabb doit pouvoir être projeté");
+static_assert(sizeof(snapshot_header) == 40, "en-tête de taille fixe");
+static_assert(sizeof(snapshot_primitive) == 56, "primitive de taille fixe");
+static_assert(sizeof(snapshot_node) == 32, "noeud de taille fixe");
+
+// FNV-1a 64 bits, incrémental
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Aplatit le graphe d'objets de la scène en tableaux de primitives.
+ */
+class scene_flattener {
+public:
+    std::vector<snapshot_material> materials;
+    std::vector<snapshot_primitive> bounded;
+    std::vector<aabb> boxes;  // Boîte de chaque primitive de `bounded`
+    std::vector<snapshot_primitive> unbounded;
+
+    void add(const Hittable& object) {
+        if (auto s = dynamic_cast<const sphere*>(&object)) {
+            snapshot_primitive prim = {primitive_sphere, material_id(s->get_material()), {}};
+            write_point(prim.data, s->get_center());
+            prim.data[3] = s->get_radius();
+            bounded.push_back(prim);
+            boxes.push_back(s->bounding_box());
+        } else if (auto t = dynamic_cast<const triangle*>(&object)) {
+            add_triangle(*t, t->get_material());
+        } else if (auto p = dynamic_cast<const plane*>(&object)) {
+            snapshot_primitive prim = {primitive_plane, material_id(p->get_material()), {}};
+            write_point(prim.data, p->get_point());
+            write_point(prim.data + 3, p->get_normal());
+            unbounded.push_back(prim);
+        } else if (auto c = dynamic_cast<const cube*>(&object)) {
+            add(c->get_faces());
+        } else if (auto m = dynamic_cast<const mesh_instance*>(&object)) {
+            add_mesh(*m);
+        } else if (auto list = dynamic_cast<const hittable_list*>(&object)) {
+            for (const auto& child : list->objects) {
+                add(*child);
+            }
+        } else {
+            std::cerr << "Snapshot: type d'objet non supporté, ignoré" << std::endl;
+        }
+    }
+
+private:
+    std::unordered_map<const material*, uint32_t> material_ids;
+
+    static void write_point(float* out, const vector3& v) {
+        out[0] = v.x();
+        out[1] = v.y();
+        out[2] = v.z();
+    }
+
+    uint32_t material_id(const shared_ptr<material>& mat) {
+        if (!mat) {
+            return no_material;
+        }
+        auto it = material_ids.find(mat.get());
+        if (it != material_ids.end()) {
+            return it->second;
+        }
+
+        snapshot_material entry;
+        color albedo;
+        if (auto l = dynamic_cast<const lambertian*>(mat.get())) {
+            entry.type = material_lambertian;
+            albedo = l->get_albedo();
+        } else if (auto m = dynamic_cast<const metal*>(mat.get())) {
+            entry.type = material_metal;
+            albedo = m->get_albedo();
+        } else if (auto d = dynamic_cast<const diffuse_light*>(mat.get())) {
+            entry.type = material_diffuse_light;
+            albedo = d->emitted();
+        } else {
+            std::cerr << "Snapshot: type de matériau non supporté" << std::endl;
+            return no_material;
+        }
+        write_point(entry.albedo, albedo);
+
+        uint32_t id = static_cast<uint32_t>(materials.size());
+        materials.push_back(entry);
+        material_ids[mat.get()] = id;
+        return id;
+    }
+
+    void add_triangle(const triangle& t, const shared_ptr<material>& mat) {
+        snapshot_primitive prim = {primitive_triangle, material_id(mat), {}};
+        for (int i = 0; i < 3; ++i) {
+            write_point(prim.data + 3 * i, t.get_vertex(i));
+        }
+        write_point(prim.data + 9, t.get_normal());
+        bounded.push_back(prim);
+        boxes.push_back(t.bounding_box());
+    }
+
+    void add_mesh(const mesh_instance& instance) {
+        float scale = instance.get_scale();
+        const point3& origin = instance.get_origin();
+        for (const auto& object : instance.get_asset()->triangles.objects) {
+            auto t = dynamic_cast<const triangle*>(object.get());
+            if (!t) {
+                continue;
+            }
+            // Triangle temporaire en espace monde : normale et boîte recalculées
+            triangle world_triangle(t->get_vertex(0) * scale + origin,
+                                    t->get_vertex(1) * scale + origin,
+                                    t->get_vertex(2) * scale + origin, nullptr);
+            add_triangle(world_triangle, instance.get_material());
+        }
+    }
+};
+
+/**
+ * @brief Construit le BVH aplati sur les primitives bornées (même heuristique que
+ * `bvh_node` : tri selon l'axe le plus long, coupure à la médiane).
+ */
+uint32_t build_nodes(const std::vector<aabb>& boxes, std::vector<uint32_t>& order, size_t start,
+                     size_t end, std::vector<snapshot_node>& nodes) {
+    aabb box;
+    for (size_t i = start; i < end; ++i) {
+        box = aabb(box, boxes[order[i]]);
+    }
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({box, static_cast<uint32_t>(start), static_cast<uint32_t>(end - start)});
+    if (end - start <= 2) {
+        return index;
+    }
+
+    int axis = box.longest_axis();
+    std::sort(order.begin() + start, order.begin() + end, [&](uint32_t a, uint32_t b) {
+        return boxes[a].get_axis_interval(axis).min < boxes[b].get_axis_interval(axis).min;
+    });
+
+    size_t mid = start + (end - start) / 2;
+    build_nodes(boxes, order, start, mid, nodes);
+    uint32_t right = build_nodes(boxes, order, mid, end, nodes);
+    nodes[index].offset = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+/**
+ * @brief Vérifie les indices du BVH lu dans le fichier, une fois au chargement.
+ *
+ * Les feuilles doivent rester dans les primitives bornées, les enfants d'un noeud interne
+ * le suivre dans le tableau (pas de cycle) et la profondeur tenir dans les piles de
+ * parcours : les traversées n'ont ensuite plus aucun test à faire.
+ */
+bool valid_nodes(const snapshot_node* nodes, uint32_t node_count, uint32_t primitive_count) {
+    std::vector<uint8_t> depth(node_count, 0);
+    for (uint32_t i = 0; i < node_count; ++i) {
+        const snapshot_node& node = nodes[i];
+        if (node.count > 0) {
+            if (uint64_t(node.offset) + node.count > primitive_count) {
+                return false;
+            }
+            continue;
+        }
+        // Enfant gauche en i + 1, enfant droit en `offset`, strictement après
+        if (node.offset <= i + 1 || node.offset >= node_count) {
+            return false;
+        }
+        // Pile : un frère en attente par niveau, plus les deux enfants du noeud courant
+        int child_depth = depth[i] + 1;
+        if (child_depth > max_tree_depth - 2) {
+            return false;
+        }
+        for (uint32_t child : {i + 1, node.offset}) {
+            depth[child] = std::max<uint8_t>(depth[child], static_cast<uint8_t>(child_depth));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Fichier en lecture seule projeté en mémoire (copié en mémoire sous Windows).
+ */
+class mapped_file {
+public:
+    mapped_file() = default;
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file() {
+#ifndef _WIN32
+        if (address) {
+            munmap(address, length);
+        }
+#endif
+    }
+
+    bool open(const std::string& filename) {
+#ifdef _WIN32
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        length = static_cast<size_t>(info.st_size);
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        address = mapping;
+        return true;
+#endif
+    }
+
+    const unsigned char* data() const {
+#ifdef _WIN32
+        return reinterpret_cast<const unsigned char*>(buffer.data());
+#else
+        return static_cast<const unsigned char*>(address);
+#endif
+    }
+
+    size_t size() const {
+#ifdef _WIN32
+        return buffer.size();
+#else
+        return length;
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    std::vector<char> buffer;
+#else
+    void* address = nullptr;
+    size_t length = 0;
+#endif
+};
+
+/**
+ * @brief Scène tracée directement depuis les tableaux du snapshot.
+ */
+class snapshot_scene : public Hittable {
+public:
+    snapshot_scene(std::unique_ptr<mapped_file> file, std::vector<shared_ptr<material>> materials)
+        : file(std::move(file)), materials(std::move(materials)) {
+        const unsigned char* cursor = this->file->data();
+        const snapshot_header* header = reinterpret_cast<const snapshot_header*>(cursor);
+        cursor += sizeof(snapshot_header) + header->material_count * sizeof(snapshot_material);
+
+        primitives = reinterpret_cast<const snapshot_primitive*>(cursor);
+        primitive_count = header->primitive_count;
+        cursor += primitive_count * sizeof(snapshot_primitive);
+
+        unbounded = reinterpret_cast<const snapshot_primitive*>(cursor);
+        unbounded_count = header->unbounded_count;
+        cursor += unbounded_count * sizeof(snapshot_primitive);
+
+        nodes = reinterpret_cast<const snapshot_node*>(cursor);
+        node_count = header->node_count;
+
+        if (node_count > 0) {
+            bbox = nodes[0].box;
+        }
+        if (unbounded_count > 0) {
+            bbox = aabb(point3(-infinity, -infinity, -infinity),
+                        point3(+infinity, +infinity, +infinity));
+        }
+
+        unsigned int numa_nodes = thread_pool::instance().node_count();
+        for (unsigned int i = 0; numa_nodes > 1 && i < numa_nodes; ++i) {
+            replicas.push_back(std::make_unique<node_replica>());
+        }
+    }
+
+    bool hit(const ray& r, interval ray_t, HitRecord& rec) const override {
+        bool hit_anything = false;
+        float closest_so_far = ray_t.max;
+
+        for (uint32_t i = 0; i < unbounded_count; ++i) {
+            if (hit_primitive(unbounded[i], r, interval(ray_t.min, closest_so_far), rec)) {
+                hit_anything = true;
+                closest_so_far = rec.t;
+            }
+        }
+
+        if (node_count > 0 &&
+            hit_subtree(local_nodes(), 0, r, interval(ray_t.min, closest_so_far), rec)) {
+            hit_anything = true;
+        }
+        return hit_anything;
+    }
+
+    bool occluded(const ray& r, interval ray_t) const override {
+        for (uint32_t i = 0; i < unbounded_count; ++i) {
+            if (occludes(unbounded[i], r, ray_t)) {
+                return true;
+            }
+        }
+        if (node_count == 0) {
+            return false;
+        }
+
+        // Parcours sans réduction de l'intervalle, arrêté à la première primitive touchée
+        const snapshot_node* tree = local_nodes();
+        uint32_t stack[max_tree_depth];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            uint32_t index = stack[--top];
+            const snapshot_node& node = tree[index];
+            if (!node.box.hit(r, ray_t)) {
+                continue;
+            }
+
+            if (node.count > 0) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    if (occludes(primitives[i], r, ray_t)) {
+                        return true;
+                    }
+                }
+            } else {
+                stack[top++] = node.offset;
+                stack[top++] = index + 1;
+            }
+        }
+        return false;
+    }
+
+    uint32_t hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const override {
+        uint32_t hits = 0;
+        for (uint32_t i = 0; i < unbounded_count; ++i) {
+            hits |= hit_primitive_lanes(unbounded[i], packet, active, recs);
+        }
+        if (node_count == 0) {
+            return hits;
+        }
+
+        // Pile commune au paquet : chaque entrée garde les voies qui ont atteint le noeud
+        struct stack_entry {
+            uint32_t node;
+            uint32_t mask;
+        };
+        const snapshot_node* tree = local_nodes();
+        stack_entry stack[max_tree_depth];
+        int top = 0;
+        stack[top++] = {0, active};
+        while (top > 0) {
+            stack_entry entry = stack[--top];
+            const snapshot_node& node = tree[entry.node];
+            uint32_t mask = node.box.hit_packet(packet, entry.mask);
+            if (mask == 0) {
+                continue;
+            }
+
+            if (node.count > 0) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    hits |= hit_primitive_lanes(primitives[i], packet, mask, recs);
+                }
+            } else if (active_lanes(mask) < min_coherent_lanes) {
+                // Paquet divergent : chaque voie restante finit le sous-arbre seule
+                for (int lane = 0; lane < packet.size; ++lane) {
+                    if ((mask >> lane & 1u) &&
+                        hit_subtree(tree, entry.node, packet.get_ray(lane),
+                                    packet.get_interval(lane), recs[lane])) {
+                        packet.t_max[lane] = recs[lane].t;
+                        hits |= 1u << lane;
+                    }
+                }
+            } else {
+                stack[top++] = {node.offset, mask};
+                stack[top++] = {entry.node + 1, mask};
+            }
+        }
+        return hits;
+    }
+
+    void add_lights(light_list& lights) const override {
+        for (uint32_t i = 0; i < primitive_count; ++i) {
+            const snapshot_primitive& prim = primitives[i];
+            const material* mat =
+                prim.material < materials.size() ? materials[prim.material].get() : nullptr;
+            if (!is_emissive(mat)) {
+                continue;
+            }
+            const float* d = prim.data;
+            if (prim.type == primitive_sphere) {
+                lights.add_sphere(point3(d[0], d[1], d[2]), d[3], mat->emitted());
+            } else if (prim.type == primitive_triangle) {
+                lights.add_triangle(point3(d[0], d[1], d[2]), point3(d[3], d[4], d[5]),
+                                    point3(d[6], d[7], d[8]), mat->emitted());
+            }
+        }
+        for (uint32_t i = 0; i < unbounded_count; ++i) {
+            if (unbounded[i].material < materials.size() &&
+                is_emissive(materials[unbounded[i].material].get())) {
+                std::cerr << "Emissive plane cannot be sampled as a light, use triangles or "
+                             "spheres"
+                          << std::endl;
+            }
+        }
+    }
+
+    aabb bounding_box() const override {
+        return bbox;
+    }
+
+private:
+    std::unique_ptr<mapped_file> file;
+    std::vector<shared_ptr<material>> materials;
+    const snapshot_primitive* primitives = nullptr;
+    const snapshot_primitive* unbounded = nullptr;
+    const snapshot_node* nodes = nullptr;
+    uint32_t primitive_count = 0;
+    uint32_t unbounded_count = 0;
+    uint32_t node_count = 0;
+    aabb bbox;
+
+    // Copie du BVH propre à un noeud NUMA, faite par le premier worker du noeud qui
+    // l'utilise : la première écriture place la mémoire sur ce noeud
+    struct node_replica {
+        std::once_flag copied;
+        std::vector<snapshot_node> nodes;
+    };
+    mutable std::vector<std::unique_ptr<node_replica>> replicas;
+
+    static constexpr int min_coherent_lanes = 2;
+
+    // BVH à parcourir par le thread courant : sa réplique locale, ou le fichier projeté
+    const snapshot_node* local_nodes() const {
+        unsigned int node = thread_pool::current_node();
+        if (node >= replicas.size()) {
+            return nodes;
+        }
+        node_replica& replica = *replicas[node];
+        std::call_once(replica.copied,
+                       [&] { replica.nodes.assign(nodes, nodes + node_count); });
+        return replica.nodes.data();
+    }
+
+    // Parcours d'un rayon isolé dans le sous-arbre de racine `root`
+    bool hit_subtree(const snapshot_node* tree, uint32_t root, const ray& r, interval ray_t,
+                     HitRecord& rec) const {
+        bool hit_anything = false;
+        float closest_so_far = ray_t.max;
+        uint32_t stack[max_tree_depth];
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            uint32_t index = stack[--top];
+            const snapshot_node& node = tree[index];
+            if (!node.box.hit(r, interval(ray_t.min, closest_so_far))) {
+                continue;
+            }
+
+            if (node.count > 0) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    if (hit_primitive(primitives[i], r, interval(ray_t.min, closest_so_far),
+                                      rec)) {
+                        hit_anything = true;
+                        closest_so_far = rec.t;
+                    }
+                }
+            } else {
+                stack[top++] = node.offset;
+                stack[top++] = index + 1;
+            }
+        }
+        return hit_anything;
+    }
+
+    // Intersection d'une primitive avec les voies `mask` d'un paquet
+    uint32_t hit_primitive_lanes(const snapshot_primitive& prim, ray_packet& packet,
+                                 uint32_t mask, HitRecord* recs) const {
+        if (prim.type == primitive_triangle) {
+            const float* d = prim.data;
+            mask = hit_triangle_packet(point3(d[0], d[1], d[2]), point3(d[3], d[4], d[5]),
+                                       point3(d[6], d[7], d[8]), packet, mask);
+        }
+        uint32_t hits = 0;
+        for (int lane = 0; lane < packet.size; ++lane) {
+            if ((mask >> lane & 1u) &&
+                hit_primitive(prim, packet.get_ray(lane), packet.get_interval(lane), recs[lane])) {
+                packet.t_max[lane] = recs[lane].t;
+                hits |= 1u << lane;
+            }
+        }
+        return hits;
+    }
+
+    bool hit_primitive(const snapshot_primitive& prim, const ray& r, interval ray_t,
+                       HitRecord& rec) const {
+        const float* d = prim.data;
+        bool hit = false;
+        switch (prim.type) {
+            case primitive_sphere:
+                hit = hit_sphere(point3(d[0], d[1], d[2]), d[3], r, ray_t, rec);
+                break;
+            case primitive_triangle:
+                hit = hit_triangle(point3(d[0], d[1], d[2]), point3(d[3], d[4], d[5]),
+                                   point3(d[6], d[7], d[8]), vector3(d[9], d[10], d[11]), r,
+                                   ray_t, rec);
+                break;
+            case primitive_plane:
+                hit = hit_plane(point3(d[0], d[1], d[2]), vector3(d[3], d[4], d[5]), r, ray_t,
+                                rec);
+                break;
+        }
+        if (hit) {
+            rec.mat = prim.material < materials.size() ? materials[prim.material] : nullptr;
+            rec.sampled_light = prim.type != primitive_plane;
+        }
+        return hit;
+    }
+
+    bool occludes(const snapshot_primitive& prim, const ray& r, interval ray_t) const {
+        const float* d = prim.data;
+        float t;
+        switch (prim.type) {
+            case primitive_sphere:
+                return intersect_sphere(point3(d[0], d[1], d[2]), d[3], r, ray_t, t);
+            case primitive_triangle:
+                return intersect_triangle(point3(d[0], d[1], d[2]), point3(d[3], d[4], d[5]),
+                                          point3(d[6], d[7], d[8]), r, ray_t, t);
+            case primitive_plane:
+                return intersect_plane(point3(d[0], d[1], d[2]), vector3(d[3], d[4], d[5]), r,
+                                       ray_t, t);
+        }
+        return false;
+    }
+};
+
+}  // namespace
+
+bool write_scene_snapshot(const hittable_list& world, const std::string& filename) {
+    scene_flattener flat;
+    flat.add(world);
+
+    std::vector<uint32_t> order(flat.bounded.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::vector<snapshot_node> nodes;
+    if (!order.empty()) {
+        build_nodes(flat.boxes, order, 0, order.size(), nodes);
+    }
+
+    std::vector<snapshot_primitive> primitives(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        primitives[i] = flat.bounded[order[i]];
+    }
+
+    snapshot_header header = {};
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version = snapshot_version;
+    header.material_count = static_cast<uint32_t>(flat.materials.size());
+    header.primitive_count = static_cast<uint32_t>(primitives.size());
+    header.unbounded_count = static_cast<uint32_t>(flat.unbounded.size());
+    header.node_count = static_cast<uint32_t>(nodes.size());
+
+    uint64_t checksum =
+        fnv1a(flat.materials.data(), flat.materials.size() * sizeof(snapshot_material));
+    checksum = fnv1a(primitives.data(), primitives.size() * sizeof(snapshot_primitive), checksum);
+    checksum = fnv1a(flat.unbounded.data(), flat.unbounded.size() * sizeof(snapshot_primitive),
+                     checksum);
+    checksum = fnv1a(nodes.data(), nodes.size() * sizeof(snapshot_node), checksum);
+    header.checksum = checksum;
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        std::cerr << "Cannot write snapshot file: " << filename << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(flat.materials.data()),
+              flat.materials.size() * sizeof(snapshot_material));
+    out.write(reinterpret_cast<const char*>(primitives.data()),
+              primitives.size() * sizeof(snapshot_primitive));
+    out.write(reinterpret_cast<const char*>(flat.unbounded.data()),
+              flat.unbounded.size() * sizeof(snapshot_primitive));
+    out.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(snapshot_node));
+
+    std::cout << "Snapshot: " << header.material_count << " materiaux, "
+              << header.primitive_count + header.unbounded_count << " primitives, "
+              << header.node_count << " noeuds -> " << filename << std::endl;
+    return static_cast<bool>(out);
+}
+
+shared_ptr<Hittable> load_scene_snapshot(const std::string& filename, bool verify_checksum) {
+    auto file = std::make_unique<mapped_file>();
+    if (!file->open(filename)) {
+        std::cerr << "Cannot open snapshot file: " << filename << std::endl;
+        return nullptr;
+    }
+
+    if (file->size() < sizeof(snapshot_header)) {
+        std::cerr << "Invalid snapshot file: " << filename << std::endl;
+        return nullptr;
+    }
+    const snapshot_header* header = reinterpret_cast<const snapshot_header*>(file->data());
+    if (std::memcmp(header->magic, snapshot_magic, sizeof(snapshot_magic)) != 0) {
+        std::cerr << "Invalid snapshot file: " << filename << std::endl;
+        return nullptr;
+    }
+    if (header->version != snapshot_version) {
+        std::cerr << "Unsupported snapshot version " << header->version << " (expected "
+                  << snapshot_version << "): " << filename << std::endl;
+        return nullptr;
+    }
+
+    uint64_t payload_size = uint64_t(header->material_count) * sizeof(snapshot_material) +
+                            uint64_t(header->primitive_count) * sizeof(snapshot_primitive) +
+                            uint64_t(header->unbounded_count) * sizeof(snapshot_primitive) +
+                            uint64_t(header->node_count) * sizeof(snapshot_node);
+    if (file->size() != sizeof(snapshot_header) + payload_size) {
+        std::cerr << "Truncated snapshot file: " << filename << std::endl;
+        return nullptr;
+    }
+    // Le checksum lit tout le fichier : vérification à la demande seulement
+    if (verify_checksum &&
+        fnv1a(file->data() + sizeof(snapshot_header), payload_size) != header->checksum) {
+        std::cerr << "Corrupted snapshot file (checksum mismatch): " << filename << std::endl;
+        return nullptr;
+    }
+    const snapshot_node* nodes = reinterpret_cast<const snapshot_node*>(
+        file->data() + file->size() - uint64_t(header->node_count) * sizeof(snapshot_node));
+    if (!valid_nodes(nodes, header->node_count, header->primitive_count)) {
+        std::cerr << "Corrupted snapshot file (invalid BVH): " << filename << std::endl;
+        return nullptr;
+    }
+
+    // Seule la table des matériaux est reconstruite, le reste est utilisé tel quel
+    const snapshot_material* entries =
+        reinterpret_cast<const snapshot_material*>(file->data() + sizeof(snapshot_header));
+    std::vector<shared_ptr<material>> materials;
+    for (uint32_t i = 0; i < header->material_count; ++i) {
+        color albedo(entries[i].albedo[0], entries[i].albedo[1], entries[i].albedo[2]);
+        if (entries[i].type == material_metal) {
+            materials.push_back(make_shared<metal>(albedo));
+        } else if (entries[i].type == material_diffuse_light) {
+            materials.push_back(make_shared<diffuse_light>(albedo));
+        } else {
+            materials.push_back(make_shared<lambertian>(albedo));
+        }
+    }
+
+    return make_shared<snapshot_scene>(std::move(file), std::move(materials));
+}
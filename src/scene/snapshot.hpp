@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "core/hittable.hpp"
+#include "core/hittable_list.hpp"
+
+/**
+ * @file snapshot.hpp
+ * @brief Scènes compilées : un fichier binaire prêt à être tracé.
+ *
+ * Un snapshot contient la table des matériaux, les primitives déjà placées en espace
+ * monde et le BVH aplati. Au rendu, le fichier est projeté en mémoire (mmap) et
+ * tracé directement : ni parsing JSON, ni parsing OBJ, ni construction de BVH.
+ *
+ * Format (version 1, little-endian) : un en-tête `snapshot_header` suivi des
+ * sections matériaux, primitives bornées (dans l'ordre des feuilles du BVH),
+ * primitives non bornées (plans) et noeuds du BVH. Le checksum FNV-1a couvre tout
+ * ce qui suit l'en-tête ; il n'est vérifié qu'à la demande.
+ */
+
+/**
+ * @brief Compile une scène (avant construction du BVH global) dans un fichier binaire.
+ *
+ * Les cubes sont écrits comme leurs 12 triangles et les instances de mesh comme leurs
+ * triangles transformés en espace monde.
+ *
+ * @param world Liste des objets de la scène, telle que produite par le chargeur JSON
+ * @param filename Chemin du fichier de sortie
+ * @return true si le fichier a été écrit
+ */
+bool write_scene_snapshot(const hittable_list& world, const std::string& filename);
+
+/**
+ * @brief Ouvre une scène compilée.
+ *
+ * L'en-tête (magic, version, tailles) et les indices du BVH sont vérifiés avant
+ * utilisation. Le checksum, qui relit tout le fichier, ne l'est que si
+ * `verify_checksum` est vrai : par défaut, seules les pages touchées par le rendu
+ * sont lues.
+ *
+ * Si le pool partagé est en mode NUMA, chaque noeud parcourt sa propre copie des
+ * noeuds du BVH (quelques Mo au plus) au lieu des pages projetées sur un seul noeud.
+ *
+ * @param filename Chemin du snapshot
+ * @param verify_checksum Vérifie le checksum de tout le contenu avant utilisation
+ *
+ * @return Un objet intersectable reposant directement sur le fichier projeté en
+ * mémoire, ou nullptr si le fichier est absent ou invalide
+ */
+shared_ptr<Hittable> load_scene_snapshot(const std::string& filename,
+                                         bool verify_checksum = false);
@@ -42,10 +42,22 @@ public:
      */
     bool hit(const ray& r, interval ray_t, HitRecord& rec) const override;
 
+    bool occluded(const ray& r, interval ray_t) const override {
+        return faces.occluded(r, ray_t);
+    }
+
+    void add_lights(light_list& lights) const override {
+        faces.add_lights(lights);
+    }
+
     aabb bounding_box() const override {
         return bbox;
     }
 
+    const hittable_list& get_faces() const {
+        return faces;
+    }
+
 private:
     point3 center;
     float size;
@@ -0,0 +1,207 @@
+#include "mesh.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "core/bvh_node.hpp"
+#include "core/hitrecord.hpp"
+#include "core/light.hpp"
+#include "shape/triangle.hpp"
+
+shared_ptr<mesh_asset> load_obj_file(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == NULL) {
+        std::cerr << "Erreur: Impossible d'ouvrir le fichier " << path << std::endl;
+        return nullptr;
+    }
+
+    std::vector<point3> mesh_vertices;
+    std::vector<std::vector<int>> mesh_faces;
+
+    char lineHeader[128];
+    int result;
+    std::vector<float> temp_vertex(3);
+    std::vector<int> temp_face(3);
+    int temp_index;
+
+    while (true) {
+        result = fscanf(file, "%127s", lineHeader);
+        if (result == EOF) {
+            break;
+        }
+
+        if (strcmp(lineHeader, "v") == 0) {
+            int matches =
+                fscanf(file, "%f %f %f\n", &temp_vertex[0], &temp_vertex[1], &temp_vertex[2]);
+            if (matches == 3) {
+                mesh_vertices.push_back(point3(temp_vertex[0], temp_vertex[1], temp_vertex[2]));
+            }
+        } else if (strcmp(lineHeader, "f") == 0) {
+            // TODO : ajouter la texture et les normales (vt/vn)
+            int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d", &temp_face[0], &temp_index,
+                                 &temp_index, &temp_face[1], &temp_index, &temp_index,
+                                 &temp_face[2], &temp_index, &temp_index);
+
+            mesh_faces.push_back(temp_face);
+        }
+    }
+
+    fclose(file);
+
+    auto asset = make_shared<mesh_asset>();
+    asset->path = path;
+
+    for (size_t j = 0; j < mesh_faces.size(); j++) {
+        // obj commence à 1 donc on soustrait 1
+        int idx0 = mesh_faces[j][0] - 1;
+        int idx1 = mesh_faces[j][1] - 1;
+        int idx2 = mesh_faces[j][2] - 1;
+
+        if (idx0 >= 0 && idx0 < mesh_vertices.size() && idx1 >= 0 &&
+            idx1 < mesh_vertices.size() && idx2 >= 0 && idx2 < mesh_vertices.size()) {
+            asset->triangles.add(make_shared<triangle>(mesh_vertices[idx0], mesh_vertices[idx1],
+                                                       mesh_vertices[idx2], nullptr));
+        }
+    }
+
+    // Un BVH ne peut pas être construit sur une liste vide
+    if (asset->triangles.objects.empty()) {
+        asset->bvh = make_shared<hittable_list>();
+    } else {
+        asset->bvh = make_shared<bvh_node>(asset->triangles, &thread_pool::instance());
+    }
+
+    return asset;
+}
+
+mesh_cache& mesh_cache::instance() {
+    static mesh_cache cache;
+    return cache;
+}
+
+shared_ptr<const mesh_asset> mesh_cache::load(const std::string& path) {
+    std::error_code ec;
+    auto write_time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        std::cerr << "Erreur: Impossible d'ouvrir le fichier " << path << std::endl;
+        return nullptr;
+    }
+
+    // Un même fichier désigné par deux chemins ("a/../mesh.obj", "./mesh.obj") partage
+    // son entrée
+    std::string key = std::filesystem::weakly_canonical(path, ec).string();
+    if (ec) {
+        key = path;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.write_time == write_time) {
+            return it->second.asset;
+        }
+    }
+
+    // Chargement hors du verrou pour ne pas bloquer les autres fichiers
+    shared_ptr<const mesh_asset> asset = load_obj_file(path);
+    if (!asset) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = entries[key];
+    if (slot.asset && slot.write_time == write_time) {
+        return slot.asset;  // Chargé en parallèle par un autre thread
+    }
+    slot.write_time = write_time;
+    slot.asset = asset;
+    return asset;
+}
+
+size_t mesh_cache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void mesh_cache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+mesh_instance::mesh_instance(shared_ptr<const mesh_asset> asset, shared_ptr<material> m,
+                             float scale, const point3& origin)
+    : asset(asset), mat(m), scale_factor(scale), inv_scale(0.0f), base(origin) {
+    // Une échelle nulle, négative ou NaN retournerait ou écraserait le repère du mesh
+    if (!(scale > 0.0f)) {
+        throw std::invalid_argument("mesh_instance: scale must be strictly positive");
+    }
+    inv_scale = 1.0f / scale;
+    aabb local = asset->bvh->bounding_box();
+    point3 local_min(local.x.min, local.y.min, local.z.min);
+    point3 local_max(local.x.max, local.y.max, local.z.max);
+    bbox = aabb(local_min * scale_factor + base, local_max * scale_factor + base);
+}
+
+bool mesh_instance::hit(const ray& r, interval ray_t, HitRecord& rec) const {
+    // P(t) = o + t*d  <=>  (P(t) - base) / s = (o - base) / s + t * d / s : t est inchangé
+    ray local((r.origin() - base) * inv_scale, r.direction() * inv_scale);
+    if (!asset->bvh->hit(local, ray_t, rec)) {
+        return false;
+    }
+
+    rec.p = r.at(rec.t);
+    rec.mat = mat;
+    return true;
+}
+
+bool mesh_instance::occluded(const ray& r, interval ray_t) const {
+    // Même changement de repère que `hit` : t est inchangé, ray_t s'applique tel quel
+    ray local((r.origin() - base) * inv_scale, r.direction() * inv_scale);
+    return asset->bvh->occluded(local, ray_t);
+}
+
+uint32_t mesh_instance::hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const {
+    uint32_t mask = bbox.hit_packet(packet, active);
+    if (mask == 0) {
+        return 0;
+    }
+
+    // Même changement de repère que `hit`, appliqué à toutes les voies
+    ray_packet local = packet;
+    for (int lane = 0; lane < packet.size; ++lane) {
+        local.origin_x[lane] = (packet.origin_x[lane] - base.x()) * inv_scale;
+        local.origin_y[lane] = (packet.origin_y[lane] - base.y()) * inv_scale;
+        local.origin_z[lane] = (packet.origin_z[lane] - base.z()) * inv_scale;
+        local.direction_x[lane] = packet.direction_x[lane] * inv_scale;
+        local.direction_y[lane] = packet.direction_y[lane] * inv_scale;
+        local.direction_z[lane] = packet.direction_z[lane] * inv_scale;
+        local.inv_direction_x[lane] = 1.0f / local.direction_x[lane];
+        local.inv_direction_y[lane] = 1.0f / local.direction_y[lane];
+        local.inv_direction_z[lane] = 1.0f / local.direction_z[lane];
+    }
+
+    uint32_t hits = asset->bvh->hit_packet(local, mask, recs);
+    for (int lane = 0; lane < packet.size; ++lane) {
+        if (hits >> lane & 1u) {
+            packet.t_max[lane] = local.t_max[lane];
+            recs[lane].p = packet.get_ray(lane).at(recs[lane].t);
+            recs[lane].mat = mat;
+        }
+    }
+    return hits;
+}
+
+void mesh_instance::add_lights(light_list& lights) const {
+    if (!is_emissive(mat.get())) {
+        return;
+    }
+    for (const auto& object : asset->triangles.objects) {
+        const auto& t = static_cast<const triangle&>(*object);
+        lights.add_triangle(t.get_vertex(0) * scale_factor + base,
+                            t.get_vertex(1) * scale_factor + base,
+                            t.get_vertex(2) * scale_factor + base, mat->emitted());
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "lib/lib.hpp"
+
+/**
+ * @file mesh.hpp
+ * @brief Géométrie de mesh partagée (assets .obj) et instances placées dans la scène.
+ *
+ * Un fichier .obj n'est lu qu'une seule fois par processus : le `mesh_cache` garde
+ * la géométrie (triangles + BVH) en espace objet et la distribue en lecture seule.
+ * Chaque placement dans la scène est un `mesh_instance` qui applique son échelle,
+ * son origine et son matériau au moment de l'intersection.
+ */
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "core/hittable.hpp"
+#include "core/hittable_list.hpp"
+#include "material/material.hpp"
+
+/**
+ * @brief Géométrie immuable d'un fichier .obj, en espace objet.
+ *
+ * Les triangles n'ont pas de matériau : il est fourni par l'instance.
+ */
+struct mesh_asset {
+    std::string path;
+    hittable_list triangles;   // Triangles en espace objet
+    shared_ptr<Hittable> bvh;  // BVH construit une seule fois sur `triangles`
+};
+
+/**
+ * @brief Cache process-wide des meshes, indexé par chemin canonique et date de modification.
+ *
+ * Un fichier modifié sur disque est rechargé au prochain `load`, les instances
+ * déjà créées gardent l'ancienne géométrie tant qu'elles existent.
+ */
+class mesh_cache {
+public:
+    static mesh_cache& instance();
+
+    /**
+     * @brief Renvoie la géométrie du fichier, en la chargeant si besoin.
+     * @param path Chemin vers le fichier .obj
+     * @return La géométrie partagée, ou nullptr si le fichier est illisible
+     */
+    shared_ptr<const mesh_asset> load(const std::string& path);
+
+    /** @brief Nombre de fichiers distincts actuellement en cache. */
+    size_t size() const;
+
+    void clear();
+
+private:
+    struct entry {
+        std::filesystem::file_time_type write_time;
+        shared_ptr<const mesh_asset> asset;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, entry> entries;
+};
+
+/**
+ * @brief Placement d'un mesh partagé dans la scène.
+ *
+ * L'échelle (uniforme) et la translation sont appliquées au rayon plutôt qu'aux
+ * sommets : le rayon est ramené en espace objet, ce qui conserve le paramètre t,
+ * puis le point d'impact est recalculé en espace monde.
+ */
+class mesh_instance : public Hittable {
+public:
+    /**
+     * @param asset Géométrie partagée issue du `mesh_cache`
+     * @param m Matériau appliqué à tous les triangles de l'instance
+     * @param scale Facteur d'échelle uniforme (strictement positif)
+     * @param origin Position de l'origine du mesh dans la scène
+     * @throws std::invalid_argument si `scale` n'est pas strictement positif
+     */
+    mesh_instance(shared_ptr<const mesh_asset> asset, shared_ptr<material> m, float scale,
+                  const point3& origin);
+
+    bool hit(const ray& r, interval ray_t, HitRecord& rec) const override;
+
+    uint32_t hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const override;
+    bool occluded(const ray& r, interval ray_t) const override;
+
+    /** @brief Triangles de l'instance, placés en espace monde, si son matériau émet. */
+    void add_lights(light_list& lights) const override;
+
+    aabb bounding_box() const override {
+        return bbox;
+    }
+
+    const shared_ptr<const mesh_asset>& get_asset() const {
+        return asset;
+    }
+    shared_ptr<material> get_material() const {
+        return mat;
+    }
+    float get_scale() const {
+        return scale_factor;
+    }
+    const point3& get_origin() const {
+        return base;
+    }
+
+private:
+    shared_ptr<const mesh_asset> asset;
+    shared_ptr<material> mat;
+    float scale_factor;
+    float inv_scale;
+    point3 base;
+    aabb bbox;
+};
+
+/**
+ * @brief Lit un fichier .obj (sommets et faces triangulaires) en espace objet.
+ * @return La géométrie chargée, ou nullptr si le fichier ne peut pas être ouvert
+ */
+shared_ptr<mesh_asset> load_obj_file(const std::string& path);
@@ -1,5 +1,7 @@
 #include "plane.hpp"
 
+#include <iostream>
+
 #include "core/hitrecord.hpp"
 
 plane::plane(const point3& point_on_plane, const vector3& normal_vector,
@@ -17,22 +19,50 @@ plane::plane(const point3& point_on_plane, const vector3& normal_vector,
 }
 
 bool plane::hit(const ray& r, interval ray_t, HitRecord& rec) const {
-    float denom = dot(normal, r.direction());
-    if (std::fabs(denom) < 1e-6f) {
+    if (!hit_plane(point, normal, r, ray_t, rec)) {
         return false;
     }
 
-    vector3 origin_to_point = point - r.origin();
-    float t = dot(origin_to_point, normal) / denom;
+    rec.mat = mat;
+    rec.sampled_light = false;
+    return true;
+}
+
+bool plane::occluded(const ray& r, interval ray_t) const {
+    float t;
+    return intersect_plane(point, normal, r, ray_t, t);
+}
 
-    if (!ray_t.contains(t)) {
+bool hit_plane(const point3& point, const vector3& normal, const ray& r, interval ray_t,
+               HitRecord& rec) {
+    float t;
+    if (!intersect_plane(point, normal, r, ray_t, t)) {
         return false;
     }
 
     rec.t = t;
     rec.p = r.at(t);
     rec.set_face_normal(r, normal);
-    rec.mat = mat;
 
     return true;
 }
+
+bool intersect_plane(const point3& point, const vector3& normal, const ray& r, interval ray_t,
+                     float& t) {
+    float denom = dot(normal, r.direction());
+    if (std::fabs(denom) < 1e-6f) {
+        return false;
+    }
+
+    vector3 origin_to_point = point - r.origin();
+    t = dot(origin_to_point, normal) / denom;
+
+    return ray_t.contains(t);
+}
+
+void plane::add_lights(light_list& lights) const {
+    if (is_emissive(mat.get())) {
+        std::cerr << "Emissive plane cannot be sampled as a light, use triangles or spheres"
+                  << std::endl;
+    }
+}
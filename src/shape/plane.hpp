@@ -24,13 +24,41 @@ public:
 
     bool hit(const ray& r, interval ray_t, HitRecord& rec) const override;
 
+    bool occluded(const ray& r, interval ray_t) const override;
+
+    /** @brief Un plan infini ne peut pas être échantillonné : avertit s'il émet. */
+    void add_lights(light_list& lights) const override;
+
     aabb bounding_box() const override {
         return bbox;
     }
 
+    const point3& get_point() const {
+        return point;
+    }
+    const vector3& get_normal() const {
+        return normal;
+    }
+    shared_ptr<material> get_material() const {
+        return mat;
+    }
+
 private:
     point3 point;
     vector3 normal;
     shared_ptr<material> mat;
     aabb bbox;
 };
+
+/**
+ * @brief Intersection rayon/plan sans matériau (normale supposée unitaire).
+ */
+bool hit_plane(const point3& point, const vector3& normal, const ray& r, interval ray_t,
+               HitRecord& rec);
+
+/**
+ * @brief Distance de l'intersection rayon/plan dans ray_t (normale supposée unitaire).
+ * @return true si le rayon touche le plan ; `t` reçoit alors la distance
+ */
+bool intersect_plane(const point3& point, const vector3& normal, const ray& r, interval ray_t,
+                     float& t);
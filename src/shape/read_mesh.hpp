@@ -1,16 +1,11 @@
 #pragma once
 
-#include <algorithm>
-#include <cstring>
-#include <fstream>
 #include <iostream>
-#include <numeric>
-#include <vector>
 
 #include "core/hittable_list.hpp"
 #include "lib/lib.hpp"
 #include "material/material.hpp"
-#include "shape/triangle.hpp"
+#include "shape/mesh.hpp"
 
 class read_mesh {
 public:
@@ -27,63 +22,23 @@ public:
               float scale, const point3& origin)
         : path(filepath), scene(world), mat_ptr(m), scale_factor(scale), base(origin) {}
 
+    /**
+     * @brief Ajoute une instance du mesh à la scène.
+     *
+     * Le fichier n'est lu qu'une fois par processus (voir `mesh_cache`) ; l'échelle
+     * et l'origine sont portées par l'instance et non recopiées dans les sommets.
+     */
     void add_mesh() {
-        FILE* file = fopen(path.c_str(), "r");
-        if (file == NULL) {
-            std::cerr << "Erreur: Impossible d'ouvrir le fichier " << path << std::endl;
+        if (!(scale_factor > 0.0f)) {
+            std::cerr << "Invalid mesh scale for " << path << ": " << scale_factor << std::endl;
             return;
         }
-
-        std::vector<point3> mesh_vertices;
-        std::vector<std::vector<int>> mesh_faces;
-
-        char lineHeader[128];
-        int result;
-        std::vector<float> temp_vertex(3);
-        std::vector<int> temp_face(3);
-        int temp_index;
-
-        while (true) {
-            result = fscanf(file, "%s", lineHeader);
-            if (result == EOF) {
-                break;
-            }
-
-            if (strcmp(lineHeader, "v") == 0) {
-                int matches =
-                    fscanf(file, "%f %f %f\n", &temp_vertex[0], &temp_vertex[1], &temp_vertex[2]);
-                if (matches == 3) {
-                    mesh_vertices.push_back(point3(temp_vertex[0], temp_vertex[1], temp_vertex[2]));
-                }
-            } else if (strcmp(lineHeader, "f") == 0) {
-                // TODO : ajouter la texture et les normales (vt/vn)
-                int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d", &temp_face[0], &temp_index,
-                                     &temp_index, &temp_face[1], &temp_index, &temp_index,
-                                     &temp_face[2], &temp_index, &temp_index);
-
-                mesh_faces.push_back(temp_face);
-            }
-        }
-
-        fclose(file);
-
-        for (size_t i = 0; i < mesh_vertices.size(); i++) {
-            mesh_vertices[i] = mesh_vertices[i] * scale_factor + base;
+        auto asset = mesh_cache::instance().load(path);
+        if (!asset) {
+            return;
         }
 
-        for (size_t j = 0; j < mesh_faces.size(); j++) {
-            // obj commence à 1 donc on soustrait 1
-            int idx0 = mesh_faces[j][0] - 1;
-            int idx1 = mesh_faces[j][1] - 1;
-            int idx2 = mesh_faces[j][2] - 1;
-
-            if (idx0 >= 0 && idx0 < mesh_vertices.size() && idx1 >= 0 &&
-                idx1 < mesh_vertices.size() && idx2 >= 0 && idx2 < mesh_vertices.size()) {
-                scene->add(make_shared<triangle>(mesh_vertices[idx0], mesh_vertices[idx1],
-                                                 mesh_vertices[idx2], mat_ptr));
-            }
-        }
-        return;
+        scene->add(make_shared<mesh_instance>(asset, mat_ptr, scale_factor, base));
     }
 
 private:
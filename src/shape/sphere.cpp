@@ -1,6 +1,7 @@
 #include "sphere.hpp"
 
 #include "core/hitrecord.hpp"
+#include "core/light.hpp"
 
 sphere::sphere(const point3& center, float radius, shared_ptr<material> material)
     : center(center), radius(std::max(1e-9f, radius)), mat(material) {
@@ -9,6 +10,39 @@ sphere::sphere(const point3& center, float radius, shared_ptr<material> material
 }
 
 bool sphere::hit(const ray& r, interval ray_t, HitRecord& rec) const {
+    if (!hit_sphere(center, radius, r, ray_t, rec))
+        return false;
+
+    rec.mat = mat;
+    rec.sampled_light = true;
+    return true;
+}
+
+bool sphere::occluded(const ray& r, interval ray_t) const {
+    float t;
+    return intersect_sphere(center, radius, r, ray_t, t);
+}
+
+void sphere::add_lights(light_list& lights) const {
+    if (is_emissive(mat.get())) {
+        lights.add_sphere(center, radius, mat->emitted());
+    }
+}
+
+bool hit_sphere(const point3& center, float radius, const ray& r, interval ray_t, HitRecord& rec) {
+    float root;
+    if (!intersect_sphere(center, radius, r, ray_t, root))
+        return false;
+
+    rec.t = root;
+    rec.p = r.at(rec.t);
+    vector3 outward_normal = (rec.p - center) / radius;
+    rec.set_face_normal(r, outward_normal);
+
+    return true;
+}
+
+bool intersect_sphere(const point3& center, float radius, const ray& r, interval ray_t, float& t) {
     vector3 oc = r.origin() - center;
     auto a = r.direction().length_squared();
     auto half_b = dot(oc, r.direction());
@@ -26,11 +60,6 @@ bool sphere::hit(const ray& r, interval ray_t, HitRecord& rec) const {
             return false;
     }
 
-    rec.t = root;
-    rec.p = r.at(rec.t);
-    vector3 outward_normal = (rec.p - center) / radius;
-    rec.set_face_normal(r, outward_normal);
-    rec.mat = mat;
-
+    t = root;
     return true;
 }
@@ -43,13 +43,39 @@ public:
 
     bool hit(const ray& r, interval ray_t, HitRecord& rec) const override;
 
+    bool occluded(const ray& r, interval ray_t) const override;
+
+    void add_lights(light_list& lights) const override;
+
     aabb bounding_box() const override {
         return bbox;
     }
 
+    const point3& get_center() const {
+        return center;
+    }
+    float get_radius() const {
+        return radius;
+    }
+    shared_ptr<material> get_material() const {
+        return mat;
+    }
+
 private:
     point3 center;
     float radius;
     shared_ptr<material> mat;
     aabb bbox;
 };
+
+/**
+ * @brief Intersection rayon/sphère sans matériau, partagée avec les scènes compilées.
+ * @return true si le rayon touche la sphère dans ray_t ; rec.mat n'est pas modifié.
+ */
+bool hit_sphere(const point3& center, float radius, const ray& r, interval ray_t, HitRecord& rec);
+
+/**
+ * @brief Distance de la plus proche intersection rayon/sphère dans ray_t, sans normale.
+ * @return true si le rayon touche la sphère ; `t` reçoit alors la distance
+ */
+bool intersect_sphere(const point3& center, float radius, const ray& r, interval ray_t, float& t);
@@ -1,6 +1,9 @@
 #include "triangle.hpp"
 
+#include <cmath>
+
 #include "core/hitrecord.hpp"
+#include "core/light.hpp"
 
 triangle::triangle(const point3& v0, const point3& v1, const point3& v2,
                    shared_ptr<material> material)
@@ -32,7 +35,59 @@ triangle::triangle(const point3& v0, const point3& v1, const point3& v2,
     bbox = aabb(min_point, max_point);
 }
 
+void triangle::add_lights(light_list& lights) const {
+    if (is_emissive(mat.get())) {
+        lights.add_triangle(v0, v1, v2, mat->emitted());
+    }
+}
+
 bool triangle::hit(const ray& r, interval ray_t, HitRecord& rec) const {
+    if (!hit_triangle(v0, v1, v2, normal, r, ray_t, rec)) {
+        return false;
+    }
+
+    rec.mat = mat;
+    rec.sampled_light = true;
+    return true;
+}
+
+uint32_t triangle::hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const {
+    uint32_t candidates = hit_triangle_packet(v0, v1, v2, packet, active);
+    uint32_t hits = 0;
+    for (int lane = 0; lane < packet.size; ++lane) {
+        if ((candidates >> lane & 1u) &&
+            hit_triangle(v0, v1, v2, normal, packet.get_ray(lane), packet.get_interval(lane),
+                         recs[lane])) {
+            recs[lane].mat = mat;
+            recs[lane].sampled_light = true;
+            packet.t_max[lane] = recs[lane].t;
+            hits |= 1u << lane;
+        }
+    }
+    return hits;
+}
+
+bool triangle::occluded(const ray& r, interval ray_t) const {
+    float t;
+    return intersect_triangle(v0, v1, v2, r, ray_t, t);
+}
+
+bool hit_triangle(const point3& v0, const point3& v1, const point3& v2, const vector3& normal,
+                  const ray& r, interval ray_t, HitRecord& rec) {
+    float t;
+    if (!intersect_triangle(v0, v1, v2, r, ray_t, t)) {
+        return false;
+    }
+
+    rec.t = t;
+    rec.p = r.at(t);
+    rec.set_face_normal(r, normal);
+
+    return true;
+}
+
+bool intersect_triangle(const point3& v0, const point3& v1, const point3& v2, const ray& r,
+                        interval ray_t, float& t) {
     const float EPSILON = 1e-8f;
     vector3 edge1 = v1 - v0;
     vector3 edge2 = v2 - v0;
@@ -60,16 +115,50 @@ bool triangle::hit(const ray& r, interval ray_t, HitRecord& rec) const {
         return false;
     }
 
-    float t = f * dot(edge2, q);
+    t = f * dot(edge2, q);
 
-    if (!ray_t.contains(t)) {
-        return false;
-    }
+    return ray_t.contains(t);
+}
 
-    rec.t = t;
-    rec.p = r.at(t);
-    rec.set_face_normal(r, normal);
-    rec.mat = mat;
+uint32_t hit_triangle_packet(const point3& v0, const point3& v1, const point3& v2,
+                             const ray_packet& packet, uint32_t active) {
+    // Marge des tests élargis : couvre les écarts d'arrondi avec le calcul scalaire
+    const float tolerance = 1e-4f;
+    const float EPSILON = 1e-8f;
+    vector3 edge1 = v1 - v0;
+    vector3 edge2 = v2 - v0;
 
-    return true;
+    int32_t candidate[ray_packet::max_size];
+    for (int i = 0; i < ray_packet::max_size; ++i) {
+        // h = d x edge2
+        float hx = packet.direction_y[i] * edge2.z() - packet.direction_z[i] * edge2.y();
+        float hy = packet.direction_z[i] * edge2.x() - packet.direction_x[i] * edge2.z();
+        float hz = packet.direction_x[i] * edge2.y() - packet.direction_y[i] * edge2.x();
+        float a = edge1.x() * hx + edge1.y() * hy + edge1.z() * hz;
+        float f = 1.0f / a;
+
+        float sx = packet.origin_x[i] - v0.x();
+        float sy = packet.origin_y[i] - v0.y();
+        float sz = packet.origin_z[i] - v0.z();
+        float u = f * (sx * hx + sy * hy + sz * hz);
+
+        // q = s x edge1
+        float qx = sy * edge1.z() - sz * edge1.y();
+        float qy = sz * edge1.x() - sx * edge1.z();
+        float qz = sx * edge1.y() - sy * edge1.x();
+        float v = f * (packet.direction_x[i] * qx + packet.direction_y[i] * qy +
+                       packet.direction_z[i] * qz);
+        float t = f * (edge2.x() * qx + edge2.y() * qy + edge2.z() * qz);
+
+        candidate[i] = (std::fabs(a) >= EPSILON) & (u >= -tolerance) &
+                       (v >= -tolerance) & (u + v <= 1.0f + tolerance) &
+                       (t >= packet.t_min[i] * (1.0f - tolerance)) &
+                       (t <= packet.t_max[i] * (1.0f + tolerance));
+    }
+
+    uint32_t mask = 0;
+    for (int i = 0; i < ray_packet::max_size; ++i) {
+        mask |= static_cast<uint32_t>(candidate[i]) << i;
+    }
+    return mask & active;
 }
@@ -43,13 +43,55 @@ public:
      */
     bool hit(const ray& r, interval ray_t, HitRecord& rec) const override;
 
+    uint32_t hit_packet(ray_packet& packet, uint32_t active, HitRecord* recs) const override;
+
+    bool occluded(const ray& r, interval ray_t) const override;
+
+    void add_lights(light_list& lights) const override;
+
     aabb bounding_box() const override {
         return bbox;
     }
 
+    const point3& get_vertex(int i) const {
+        return i == 0 ? v0 : (i == 1 ? v1 : v2);
+    }
+    const vector3& get_normal() const {
+        return normal;
+    }
+    shared_ptr<material> get_material() const {
+        return mat;
+    }
+
 private:
     point3 v0, v1, v2;
     vector3 normal;
     shared_ptr<material> mat;
     aabb bbox;
 };
+
+/**
+ * @brief Intersection rayon/triangle (Möller-Trumbore) sans matériau.
+ * @return true si le rayon touche le triangle dans ray_t ; rec.mat n'est pas modifié.
+ */
+bool hit_triangle(const point3& v0, const point3& v1, const point3& v2, const vector3& normal,
+                  const ray& r, interval ray_t, HitRecord& rec);
+
+/**
+ * @brief Distance de l'intersection rayon/triangle dans ray_t, sans normale.
+ * @return true si le rayon touche le triangle ; `t` reçoit alors la distance
+ */
+bool intersect_triangle(const point3& v0, const point3& v1, const point3& v2, const ray& r,
+                        interval ray_t, float& t);
+
+/**
+ * @brief Présélection vectorisée de Möller-Trumbore sur toutes les voies d'un paquet.
+ *
+ * Les tests sont légèrement élargis : une voie rejetée ne touche sûrement pas le
+ * triangle, une voie retenue doit être confirmée par `hit_triangle`, qui calcule
+ * l'intersection exacte.
+ *
+ * @return Masque des voies actives susceptibles de toucher le triangle
+ */
+uint32_t hit_triangle_packet(const point3& v0, const point3& v1, const point3& v2,
+                             const ray_packet& packet, uint32_t active);
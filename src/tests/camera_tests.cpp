@@ -0,0 +1,684 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/bvh_node.hpp"
+#include "core/camera.hpp"
+#include "material/material.hpp"
+#include "scene/snapshot.hpp"
+#include "shape/mesh.hpp"
+#include "shape/plane.hpp"
+#include "shape/sphere.hpp"
+
+namespace {
+
+hittable_list make_world() {
+    hittable_list world;
+    world.add(make_shared<sphere>(point3(0, 0, -2), 0.5f,
+                                  make_shared<lambertian>(color(0.7f, 0.3f, 0.3f))));
+    world.add(make_shared<sphere>(point3(0, -100.5f, -2), 100.0f,
+                                  make_shared<metal>(color(0.8f, 0.8f, 0.8f))));
+    // Petite source : les comparaisons entre modes couvrent aussi l'éclairage direct
+    world.add(make_shared<sphere>(point3(0.6f, 0.5f, -1.6f), 0.15f,
+                                  make_shared<diffuse_light>(color(6, 6, 6))));
+    return world;
+}
+
+camera make_test_camera(int samples) {
+    camera cam;
+    cam.image_width = 32;
+    cam.aspect_ratio = 2.0f;
+    cam.samples_per_pixel = samples;
+    cam.max_depth = 8;
+    cam.seed = 42;
+    return cam;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Rend la scène dans un film flottant, sans fichier : chaque test tourne dans son propre
+// processus sous ctest -j, un fichier commun serait écrasé par les autres
+film render_film(camera& cam, const hittable_list& world) {
+    film result(0, 0);
+    cam.render_film(world, result, "");
+    return result;
+}
+
+// Monde qui relève chaque rayon primaire (parti de l'origine de la caméra) avec l'état de
+// l'échantillonneur à cet instant : un autre intégrateur peut ensuite rejouer le chemin
+class recording_world : public Hittable {
+public:
+    explicit recording_world(shared_ptr<Hittable> scene) : scene(scene) {}
+
+    bool hit(const ray& r, interval ray_t, HitRecord& rec) const override {
+        if (r.origin().length_squared() == 0.0f) {
+            primaries.push_back({r, save_sample_state()});
+        }
+        return scene->hit(r, ray_t, rec);
+    }
+
+    aabb bounding_box() const override {
+        return scene->bounding_box();
+    }
+
+    shared_ptr<Hittable> scene;
+    mutable std::vector<std::pair<ray, sample_state>> primaries;
+};
+
+// Monde qui lève une exception après `limit` intersections : simule un processus tué au
+// milieu d'un rendu. Ralenti d'une milliseconde toutes les 1024 intersections, le rendu
+// dure assez longtemps pour que des checkpoints soient écrits avant l'interruption
+class crashing_world : public Hittable {
+public:
+    crashing_world(shared_ptr<Hittable> scene, uint64_t limit, bool slow = false)
+        : scene(scene), limit(limit), slow(slow) {}
+
+    bool hit(const ray& r, interval ray_t, HitRecord& rec) const override {
+        uint64_t call = calls.fetch_add(1);
+        if (call >= limit) {
+            throw std::runtime_error("render interrupted");
+        }
+        if (slow && call % 1024 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return scene->hit(r, ray_t, rec);
+    }
+
+    aabb bounding_box() const override {
+        return scene->bounding_box();
+    }
+
+private:
+    shared_ptr<Hittable> scene;
+    uint64_t limit;
+    bool slow;
+    mutable std::atomic<uint64_t> calls{0};
+};
+
+// Intégrateur récursif de référence, sans éclairage direct ni roulette russe
+color recursive_color(const ray& r, const Hittable& world, int depth) {
+    if (depth <= 0) {
+        return color(0, 0, 0);
+    }
+    HitRecord rec;
+    if (!world.hit(r, interval(0.00001f, infinity), rec)) {
+        // Même dégradé que camera::background_color
+        float t = 0.5f * (unit_vector(r.direction()).y() + 1.0f);
+        return (1.0f - t) * color(0.75f, 0.75f, 0.75f) + t * color(0.9f, 0.8f, 0.7f);
+    }
+    color emitted = rec.mat->emitted();
+    ray scattered;
+    color attenuation;
+    if (!rec.mat->scatter(r, rec, attenuation, scattered)) {
+        return emitted;
+    }
+    return emitted + attenuation * recursive_color(scattered, world, depth - 1);
+}
+
+}  // namespace
+
+// L'intégrateur itératif suit exactement le chemin de l'intégrateur récursif : à partir du
+// même rayon primaire et des mêmes tirages, chaque pixel reçoit la même couleur
+TEST(CameraTest, IterativeIntegratorMatchesRecursion) {
+    auto scene = make_shared<bvh_node>(make_world());
+    auto recorder = make_shared<recording_world>(scene);
+    hittable_list world(recorder);
+
+    // Un thread, une seule tuile jamais redécoupée : pixels rendus ligne par ligne
+    thread_pool pool(1);
+    camera cam = make_test_camera(1);
+    cam.pool = &pool;
+    cam.packet_size = 1;
+    cam.tile_size = 64;
+    cam.min_tile_size = 64;
+    cam.russian_roulette = false;
+    cam.sample_lights = false;
+    film image = render_film(cam, world);
+
+    unsigned int width = image.get_width();
+    unsigned int height = image.get_height();
+    ASSERT_EQ(recorder->primaries.size(), width * height);
+    int bounced = 0;
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            const auto& [primary, state] = recorder->primaries[y * width + x];
+            restore_sample_state(state);
+            color expected = recursive_color(primary, *scene, cam.max_depth);
+            color actual = image.get(x, height - 1 - y).mean();
+            for (int c = 0; c < 3; ++c) {
+                ASSERT_NEAR(actual[c], expected[c], 1e-5f * (1.0f + expected[c])) << x << " " << y;
+            }
+            HitRecord rec;
+            bounced += scene->hit(primary, interval(0.00001f, infinity), rec) ? 1 : 0;
+        }
+    }
+    EXPECT_GT(bounced, static_cast<int>(width * height) / 4);
+}
+
+// Un rendu repris depuis un checkpoint donne exactement l'image d'un rendu d'une traite
+TEST(CameraTest, ResumeMatchesUninterruptedRender) {
+    hittable_list world = make_world();
+    std::string dir = testing::TempDir();
+    std::string checkpoint = dir + "camera_tests.ckpt";
+    std::remove(checkpoint.c_str());
+
+    camera full = make_test_camera(8);
+    full.render(world, dir + "camera_tests_full.png");
+
+    camera first_half = make_test_camera(3);
+    first_half.checkpoint_file = checkpoint;
+    first_half.render(world, dir + "camera_tests_half.png");
+
+    camera resumed = make_test_camera(8);
+    resumed.checkpoint_file = checkpoint;
+    resumed.resume = true;
+    resumed.pass_samples = 2;  // Découpage différent : sans effet sur le résultat
+    camera::render_stats stats = resumed.render(world, dir + "camera_tests_resumed.png");
+
+    EXPECT_EQ(stats.min_samples, 8u);
+    EXPECT_EQ(read_file(dir + "camera_tests_full.png"),
+              read_file(dir + "camera_tests_resumed.png"));
+}
+
+// Un rendu d'une seule passe est lui aussi sauvegardé en cours de route : interrompu au
+// milieu, il reprend depuis son checkpoint et donne l'image d'un rendu d'une traite
+TEST(CameraTest, SinglePassRenderResumesFromMidPassCheckpoint) {
+    auto scene = make_shared<bvh_node>(make_world());
+    std::string dir = testing::TempDir();
+    std::string checkpoint = dir + "camera_tests_single_pass.ckpt";
+    std::remove(checkpoint.c_str());
+
+    // Même monde pour les trois rendus : les paquets passent rayon par rayon
+    auto unlimited = [&] {
+        return hittable_list(make_shared<crashing_world>(scene, UINT64_MAX));
+    };
+    camera full = make_test_camera(64);
+    film expected = render_film(full, unlimited());
+
+    camera interrupted = make_test_camera(64);
+    interrupted.checkpoint_file = checkpoint;
+    interrupted.checkpoint_interval = 0.01f;
+    interrupted.tile_size = 8;
+    hittable_list crashing(make_shared<crashing_world>(scene, 32 * 16 * 64, true));
+    film partial(0, 0);
+    EXPECT_THROW(interrupted.render_film(crashing, partial, ""), std::runtime_error);
+
+    // Le checkpoint contient une partie des échantillons, sans fichier temporaire
+    film saved(expected.get_width(), expected.get_height());
+    film_checkpoint_info info;
+    ASSERT_TRUE(saved.load_checkpoint(checkpoint, info));
+    uint64_t saved_samples = 0;
+    for (unsigned int y = 0; y < saved.get_height(); ++y) {
+        for (unsigned int x = 0; x < saved.get_width(); ++x) {
+            saved_samples += saved.get(x, y).count;
+        }
+    }
+    EXPECT_GT(saved_samples, 0u);
+    EXPECT_LT(saved_samples, 32u * 16 * 64);
+    EXPECT_FALSE(std::ifstream(checkpoint + ".tmp").good());
+
+    camera resumed = make_test_camera(64);
+    resumed.checkpoint_file = checkpoint;
+    resumed.resume = true;
+    film result = render_film(resumed, unlimited());
+    for (unsigned int y = 0; y < result.get_height(); ++y) {
+        for (unsigned int x = 0; x < result.get_width(); ++x) {
+            ASSERT_EQ(result.get(x, y).count, 64u);
+            ASSERT_EQ(result.get(x, y).sum.x(), expected.get(x, y).sum.x()) << x << " " << y;
+            ASSERT_EQ(result.get(x, y).sum.z(), expected.get(x, y).sum.z()) << x << " " << y;
+        }
+    }
+    std::remove(checkpoint.c_str());
+}
+
+namespace {
+
+// Rend `world` en rayons isolés puis en paquets de 4, 8 et 16 : sommes identiques au bit près
+void expect_packets_match(const hittable_list& world, const std::string& label) {
+    camera single = make_test_camera(4);
+    single.packet_size = 1;
+    film expected = render_film(single, world);
+
+    for (int size : {4, 8, 16}) {
+        camera packets = make_test_camera(4);
+        packets.packet_size = size;
+        film result = render_film(packets, world);
+        for (unsigned int y = 0; y < result.get_height(); ++y) {
+            for (unsigned int x = 0; x < result.get_width(); ++x) {
+                ASSERT_EQ(result.get(x, y).sum.x(), expected.get(x, y).sum.x())
+                    << label << " " << size << " " << x << " " << y;
+                ASSERT_EQ(result.get(x, y).sum.z(), expected.get(x, y).sum.z())
+                    << label << " " << size << " " << x << " " << y;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+// Les rayons primaires tracés en paquets donnent la même image que des rayons isolés, sur des
+// sphères, sur un mesh (hit_triangle_packet, mesh_instance::hit_packet) et sur sa scène compilée
+TEST(CameraTest, PacketsMatchSingleRays) {
+    hittable_list spheres = make_world();
+    spheres.add(make_shared<sphere>(point3(0.6f, 0.1f, -1.5f), 0.2f,
+                                    make_shared<lambertian>(color(0.2f, 0.6f, 0.3f))));
+    expect_packets_match(hittable_list(make_shared<bvh_node>(spheres)), "spheres");
+
+    // Grille ondulée de 128 triangles ; origine et échelle quelconques : aucun rayon
+    // primaire ne passe par une arête
+    const int n = 8;
+    std::ostringstream obj;
+    for (int y = 0; y <= n; ++y) {
+        for (int x = 0; x <= n; ++x) {
+            obj << "v " << x << " " << y << " " << ((x * 7 + y * 3) % 5) * 0.2f << "\n";
+        }
+    }
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            int a = y * (n + 1) + x + 1;
+            int b = a + 1, c = a + n + 2, d = a + n + 1;
+            obj << "f " << a << "/1/1 " << b << "/1/1 " << c << "/1/1\n";
+            obj << "f " << a << "/1/1 " << c << "/1/1 " << d << "/1/1\n";
+        }
+    }
+    std::string dir = testing::TempDir();
+    std::string mesh_path = dir + "camera_tests_packets.obj";
+    std::ofstream(mesh_path) << obj.str();
+    auto asset = mesh_cache::instance().load(mesh_path);
+    ASSERT_NE(asset, nullptr);
+    ASSERT_EQ(asset->triangles.objects.size(), 2u * n * n);
+
+    hittable_list meshes = make_world();
+    meshes.add(make_shared<mesh_instance>(asset, make_shared<lambertian>(color(0.4f, 0.5f, 0.6f)),
+                                          0.31f, point3(-1.23f, -0.47f, -2.9f)));
+    hittable_list mesh_world(make_shared<bvh_node>(meshes));
+    expect_packets_match(mesh_world, "mesh");
+
+    std::string snapshot_path = dir + "camera_tests_packets.rbs";
+    ASSERT_TRUE(write_scene_snapshot(meshes, snapshot_path));
+    auto snapshot = load_scene_snapshot(snapshot_path);
+    ASSERT_NE(snapshot, nullptr);
+    HitRecord rec;
+    ASSERT_TRUE(snapshot->hit(ray(point3(0, 0, 0), vector3(0, 0, -1)), interval(0.001f, infinity),
+                              rec));
+    expect_packets_match(hittable_list(snapshot), "snapshot");
+
+    std::remove(mesh_path.c_str());
+    std::remove(snapshot_path.c_str());
+}
+
+// L'intégrateur wavefront, par lots de toute taille et avec ou sans tri des rayons,
+// donne la même image que le rendu chemin par chemin
+TEST(CameraTest, WavefrontMatchesPathByPath) {
+    hittable_list world = make_world();
+    world = hittable_list(make_shared<bvh_node>(world));
+    std::string dir = testing::TempDir();
+
+    camera reference = make_test_camera(4);
+    reference.render(world, dir + "camera_tests_reference.png");
+    std::string expected = read_file(dir + "camera_tests_reference.png");
+
+    for (int batch : {1, 100, 4096}) {
+        for (bool sorted : {false, true}) {
+            camera wavefront = make_test_camera(4);
+            wavefront.wavefront_batch = batch;
+            wavefront.sort_rays = sorted;
+            wavefront.render(world, dir + "camera_tests_wavefront.png");
+            EXPECT_EQ(expected, read_file(dir + "camera_tests_wavefront.png"))
+                << batch << (sorted ? " sorted" : "");
+        }
+    }
+}
+
+// Les attributs du premier point touché sont ceux de la surface visée, identiques dans
+// tous les modes de tracé ; l'image débruitée est écrite à partir de ces attributs
+TEST(CameraTest, FeatureBuffersMatchAcrossModes) {
+    hittable_list world = make_world();
+    world = hittable_list(make_shared<bvh_node>(world));
+    std::string dir = testing::TempDir();
+
+    camera single = make_test_camera(4);
+    single.packet_size = 1;
+    film expected = render_film(single, world);
+
+    // Pixel central : la sphère rouge, à 1.5 de la caméra, vue presque de face
+    sample_features center = expected.get(16, 8).mean_features();
+    EXPECT_NEAR(center.albedo.x(), 0.7f, 1e-4f);
+    EXPECT_NEAR(center.albedo.y(), 0.3f, 1e-4f);
+    EXPECT_NEAR(center.depth, 1.5f, 0.1f);
+    EXPECT_GT(center.normal.z(), 0.9f);
+
+    camera packets = make_test_camera(4);
+    packets.packet_size = 8;
+    camera wavefront = make_test_camera(4);
+    wavefront.wavefront_batch = 100;
+    wavefront.denoise = true;
+    for (camera* cam : {&packets, &wavefront}) {
+        film result = render_film(*cam, world);
+        for (unsigned int y = 0; y < result.get_height(); ++y) {
+            for (unsigned int x = 0; x < result.get_width(); ++x) {
+                const pixel_accumulator& a = expected.get(x, y);
+                const pixel_accumulator& b = result.get(x, y);
+                ASSERT_EQ(a.albedo_sum.x(), b.albedo_sum.x()) << x << " " << y;
+                ASSERT_EQ(a.normal_sum.z(), b.normal_sum.z()) << x << " " << y;
+                ASSERT_EQ(a.depth_sum, b.depth_sum) << x << " " << y;
+            }
+        }
+        if (cam->denoise) {
+            std::string denoised = dir + "camera_tests_denoised.png";
+            cam->write_image(result, denoised);
+            EXPECT_FALSE(read_file(denoised).empty());
+        }
+    }
+}
+
+// Les parties d'un rendu distribué, fusionnées, redonnent le rendu complet : au bit près
+// par bandes de lignes, aux arrondis de sommation près par plages d'échantillons
+TEST(CameraTest, MergedPartsMatchFullRender) {
+    hittable_list world = make_world();
+    world = hittable_list(make_shared<bvh_node>(world));
+    std::string dir = testing::TempDir();
+
+    camera full = make_test_camera(6);
+    film expected = render_film(full, world);
+
+    for (part_split split : {part_split::rows, part_split::samples}) {
+        film merged(expected.get_width(), expected.get_height());
+        for (int k = 0; k < 4; ++k) {
+            camera part = make_test_camera(6);
+            part.part = {k, 4, split};
+            std::string file = dir + "camera_tests_part.film";
+            part.render(world, file);
+            film_checkpoint_info info;
+            ASSERT_TRUE(merged.merge_checkpoint(file, info));
+            EXPECT_EQ(info.target_samples, 6u);
+            EXPECT_EQ(info.part_index, static_cast<uint32_t>(k));
+            EXPECT_EQ(info.part_count, 4u);
+            EXPECT_EQ(info.part_split, static_cast<uint32_t>(split));
+        }
+
+        for (unsigned int y = 0; y < merged.get_height(); ++y) {
+            for (unsigned int x = 0; x < merged.get_width(); ++x) {
+                const pixel_accumulator& a = expected.get(x, y);
+                const pixel_accumulator& b = merged.get(x, y);
+                ASSERT_EQ(a.count, b.count);
+                if (split == part_split::rows) {
+                    ASSERT_EQ(a.sum.x(), b.sum.x()) << x << " " << y;
+                    ASSERT_EQ(a.sum.z(), b.sum.z()) << x << " " << y;
+                } else {
+                    ASSERT_NEAR(a.sum.x(), b.sum.x(), 1e-4f * (1.0f + a.sum.x()));
+                    ASSERT_NEAR(a.depth_sum, b.depth_sum, 1e-4f * (1.0f + a.depth_sum));
+                }
+            }
+        }
+    }
+}
+
+// Reprise d'une bande de lignes terminée : aucune passe n'est rendue à nouveau, même si les
+// lignes hors de la bande n'ont aucun échantillon
+TEST(CameraTest, RowPartResumeSkipsCompletedPasses) {
+    hittable_list world = make_world();
+    std::string checkpoint = testing::TempDir() + "camera_tests_band.ckpt";
+    std::remove(checkpoint.c_str());
+
+    camera part = make_test_camera(6);
+    part.part = {1, 4, part_split::rows};
+    part.pass_samples = 2;
+    part.checkpoint_file = checkpoint;
+    film expected = render_film(part, world);
+    EXPECT_EQ(expected.min_sample_count(), 0u);
+
+    camera resumed = make_test_camera(6);
+    resumed.part = {1, 4, part_split::rows};
+    resumed.pass_samples = 2;
+    resumed.checkpoint_file = checkpoint;
+    resumed.resume = true;
+    film result(0, 0);
+    camera::render_stats stats = resumed.render_film(world, result, "");
+    EXPECT_EQ(stats.passes, 0);
+    EXPECT_EQ(result.min_sample_count(8, 12), 6u);  // Lignes [4, 8) depuis le bas
+
+    // Le checkpoint d'une autre partie n'est pas repris
+    camera other = make_test_camera(6);
+    other.part = {2, 4, part_split::rows};
+    other.pass_samples = 2;
+    other.checkpoint_file = checkpoint;
+    other.resume = true;
+    stats = other.render_film(world, result, "");
+    EXPECT_EQ(stats.passes, 3);
+    std::remove(checkpoint.c_str());
+}
+
+// Une visée quelconque (`view_direction` hors des axes) voit la scène de référence, vue selon
+// -z, tournée dans la base (u, v, w) de la caméra : mêmes profondeurs, normales tournées
+TEST(CameraTest, OffAxisViewMatchesRotatedScene) {
+    vector3 direction(0.3f, -0.4f, -1.0f);
+    vector3 w = unit_vector(-direction);
+    vector3 u = unit_vector(cross(vector3(0, 1, 0), w));
+    vector3 v = cross(w, u);
+    auto rotate = [&](const vector3& p) { return p.x() * u + p.y() * v + p.z() * w; };
+
+    hittable_list reference;
+    hittable_list rotated;
+    auto add = [&](const point3& center, float radius, shared_ptr<material> mat) {
+        reference.add(make_shared<sphere>(center, radius, mat));
+        rotated.add(make_shared<sphere>(rotate(center), radius, mat));
+    };
+    add(point3(0, 0, -2), 0.5f, make_shared<lambertian>(color(0.7f, 0.3f, 0.3f)));
+    add(point3(0.7f, 0.3f, -2.5f), 0.4f, make_shared<metal>(color(0.8f, 0.8f, 0.8f)));
+    add(point3(-0.6f, -0.2f, -1.5f), 0.3f, make_shared<lambertian>(color(0.2f, 0.6f, 0.3f)));
+
+    camera straight = make_test_camera(4);
+    film expected = render_film(straight, reference);
+    camera off_axis = make_test_camera(4);
+    off_axis.view_direction = direction;
+    film result = render_film(off_axis, rotated);
+
+    for (unsigned int y = 0; y < result.get_height(); ++y) {
+        for (unsigned int x = 0; x < result.get_width(); ++x) {
+            const pixel_accumulator& a = expected.get(x, y);
+            const pixel_accumulator& b = result.get(x, y);
+            ASSERT_NEAR(b.depth_sum, a.depth_sum, 1e-3f * (1.0f + a.depth_sum)) << x << " " << y;
+            vector3 normal = rotate(a.normal_sum);
+            for (int i = 0; i < 3; ++i) {
+                ASSERT_NEAR(b.normal_sum[i], normal[i], 1e-3f) << x << " " << y;
+            }
+        }
+    }
+}
+
+// Les tirages ne dépendent que de (graine, pixel, échantillon, dimension) : le nombre de
+// threads ne change pas l'image
+TEST(CameraTest, ThreadCountDoesNotChangeImage) {
+    hittable_list world = make_world();
+    std::string dir = testing::TempDir();
+    std::string expected;
+    for (unsigned int threads : {1u, 3u}) {
+        thread_pool pool(threads);
+        camera cam = make_test_camera(4);
+        cam.pool = &pool;
+        cam.tile_size = 8;
+        cam.pixel_sampler = make_sampler(sampler_type::independent, 4);
+        cam.render(world, dir + "camera_tests_threads.png");
+        std::string image = read_file(dir + "camera_tests_threads.png");
+        if (expected.empty()) {
+            expected = image;
+        }
+        EXPECT_EQ(expected, image) << threads;
+    }
+}
+
+// L'éclairage direct converge vers la même image que les seuls rebonds, avec bien moins
+// de bruit quand la source est petite
+TEST(CameraTest, LightSamplingIsUnbiasedAndLessNoisy) {
+    hittable_list world;
+    world.add(make_shared<sphere>(point3(0, -100.5f, -2), 100.0f,
+                                  make_shared<lambertian>(color(0.5f, 0.5f, 0.5f))));
+    world.add(make_shared<sphere>(point3(0, 0, -2), 0.5f,
+                                  make_shared<lambertian>(color(0.7f, 0.3f, 0.3f))));
+    world.add(make_shared<sphere>(point3(0, 1.2f, -2), 0.15f,
+                                  make_shared<diffuse_light>(color(40, 40, 40))));
+
+    double mean[2] = {};
+    double error[2] = {};
+    for (int sampled = 0; sampled < 2; ++sampled) {
+        camera cam = make_test_camera(256);
+        cam.image_width = 16;
+        cam.sample_lights = sampled == 1;
+        film image = render_film(cam, world);
+        for (unsigned int y = 0; y < image.get_height(); ++y) {
+            for (unsigned int x = 0; x < image.get_width(); ++x) {
+                color value = image.get(x, y).mean();
+                mean[sampled] += value.x() + value.y() + value.z();
+                error[sampled] += image.get(x, y).relative_error();
+            }
+        }
+    }
+
+    EXPECT_NEAR(mean[1], mean[0], 0.03 * mean[0]);
+    EXPECT_LT(error[1], 0.5 * error[0]);
+}
+
+// Un plan émissif, que l'éclairage direct ne tire pas, garde tout son poids à côté d'une
+// source échantillonnée : même image moyenne avec ou sans éclairage direct
+TEST(CameraTest, UnsampledEmittersKeepFullWeight) {
+    hittable_list world;
+    world.add(make_shared<sphere>(point3(0, -100.5f, -2), 100.0f,
+                                  make_shared<lambertian>(color(0.5f, 0.5f, 0.5f))));
+    world.add(make_shared<sphere>(point3(0, 0, -2), 0.5f,
+                                  make_shared<lambertian>(color(0.7f, 0.3f, 0.3f))));
+    world.add(make_shared<sphere>(point3(0, 1.2f, -2), 0.15f,
+                                  make_shared<diffuse_light>(color(40, 40, 40))));
+    world.add(make_shared<plane>(point3(0, 3, 0), vector3(0, -1, 0),
+                                 make_shared<diffuse_light>(color(2, 2, 2))));
+
+    // Le plan reste aussi une primitive non bornée de la scène compilée
+    std::string snapshot_path = testing::TempDir() + "camera_tests_emitters.rbs";
+    ASSERT_TRUE(write_scene_snapshot(world, snapshot_path));
+    auto snapshot = load_scene_snapshot(snapshot_path);
+    ASSERT_NE(snapshot, nullptr);
+    hittable_list compiled(snapshot);
+
+    double mean[3] = {};
+    for (int run = 0; run < 3; ++run) {
+        camera cam = make_test_camera(256);
+        cam.image_width = 16;
+        cam.sample_lights = run > 0;
+        film image = render_film(cam, run < 2 ? world : compiled);
+        for (unsigned int y = 0; y < image.get_height(); ++y) {
+            for (unsigned int x = 0; x < image.get_width(); ++x) {
+                color value = image.get(x, y).mean();
+                mean[run] += value.x() + value.y() + value.z();
+            }
+        }
+    }
+
+    EXPECT_NEAR(mean[1], mean[0], 0.03 * mean[0]);
+    EXPECT_NEAR(mean[2], mean[0], 0.03 * mean[0]);
+    std::remove(snapshot_path.c_str());
+}
+
+// Les tuiles sont parcourues en Z : chaque bloc aligné de 2x2 (puis 4x4...) tuiles est
+// rendu d'un seul tenant, y compris quand la grille n'est pas une puissance de deux
+TEST(CameraTest, TilesFollowMortonOrder) {
+    std::vector<uint32_t> square = morton_tile_order(4, 4);
+    std::vector<uint32_t> expected = {0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15};
+    EXPECT_EQ(square, expected);
+
+    const int tiles_x = 5, tiles_y = 3;
+    std::vector<uint32_t> order = morton_tile_order(tiles_x, tiles_y);
+    ASSERT_EQ(order.size(), 15u);
+    std::vector<bool> seen(order.size(), false);
+    for (uint32_t tile : order) {
+        ASSERT_LT(tile, order.size());
+        EXPECT_FALSE(seen[tile]);
+        seen[tile] = true;
+    }
+    for (int block = 2; block <= 4; block *= 2) {
+        // Rangs des tuiles d'un même bloc : contigus dans l'ordre de rendu
+        std::vector<int> first(64, -1), last(64, -1), count(64, 0);
+        for (int rank = 0; rank < static_cast<int>(order.size()); ++rank) {
+            int id = (order[rank] / tiles_x / block) * 8 + (order[rank] % tiles_x) / block;
+            first[id] = first[id] < 0 ? rank : first[id];
+            last[id] = rank;
+            count[id]++;
+        }
+        for (int id = 0; id < 64; ++id) {
+            if (count[id] > 0) {
+                EXPECT_EQ(last[id] - first[id] + 1, count[id]) << block << " " << id;
+            }
+        }
+    }
+    EXPECT_TRUE(morton_tile_order(0, 3).empty());
+}
+
+// La roulette russe arrête des chemins mais repondère les survivants : l'image moyenne
+// est la même qu'avec des chemins complets, pour moins de rayons par échantillon
+TEST(CameraTest, RussianRouletteStaysUnbiased) {
+    hittable_list world;
+    world.add(make_shared<sphere>(point3(0, -100.5f, -2), 100.0f,
+                                  make_shared<lambertian>(color(0.4f, 0.4f, 0.4f))));
+    world.add(make_shared<sphere>(point3(0, 0, -2), 0.5f,
+                                  make_shared<lambertian>(color(0.3f, 0.2f, 0.2f))));
+    world.add(make_shared<sphere>(point3(0.7f, 0.6f, -1.8f), 0.3f,
+                                  make_shared<diffuse_light>(color(8, 8, 8))));
+
+    double mean[2] = {};
+    double rays[2] = {};
+    for (int roulette = 0; roulette < 2; ++roulette) {
+        camera cam = make_test_camera(256);
+        cam.image_width = 16;
+        cam.max_depth = 16;
+        cam.russian_roulette = roulette == 1;
+        cam.roulette_start_bounce = 1;  // Roulette dès le premier rebond : effet maximal
+        film image(0, 0);
+        rays[roulette] = cam.render_film(world, image, "").rays_per_sample;
+        for (unsigned int y = 0; y < image.get_height(); ++y) {
+            for (unsigned int x = 0; x < image.get_width(); ++x) {
+                color value = image.get(x, y).mean();
+                mean[roulette] += value.x() + value.y() + value.z();
+            }
+        }
+    }
+
+    EXPECT_NEAR(mean[1], mean[0], 0.02 * mean[0]);
+    EXPECT_LT(rays[1], 0.8 * rays[0]);
+}
+
+// Mode progressif : l'image intermédiaire est celle des passes déjà rendues, écrite par
+// renommage (aucun fichier temporaire ne reste), et l'image finale ne dépend pas des passes
+TEST(CameraTest, ProgressiveSnapshotsShowCompletedPasses) {
+    hittable_list world = make_world();
+    std::string dir = testing::TempDir();
+    std::string snapshot = dir + "camera_tests_progressive_snapshot.png";
+    std::remove(snapshot.c_str());
+
+    camera progressive = make_test_camera(6);
+    progressive.pass_samples = 2;
+    progressive.snapshot_output = snapshot;
+    camera::render_stats stats = progressive.render(world, dir + "camera_tests_progressive.png");
+    EXPECT_EQ(stats.passes, 3);
+
+    // Dernière image intermédiaire : après la deuxième passe, 4 échantillons par pixel
+    camera four = make_test_camera(4);
+    four.render(world, dir + "camera_tests_progressive_4.png");
+    EXPECT_EQ(read_file(snapshot), read_file(dir + "camera_tests_progressive_4.png"));
+    EXPECT_FALSE(std::ifstream(snapshot + ".tmp").good());
+
+    camera direct = make_test_camera(6);
+    direct.render(world, dir + "camera_tests_progressive_6.png");
+    EXPECT_EQ(read_file(dir + "camera_tests_progressive.png"),
+              read_file(dir + "camera_tests_progressive_6.png"));
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <fstream>
+
+#include "denoiser.hpp"
+#include "film.hpp"
+#include "lib/thread_pool.hpp"
+
+// Des échantillons constants donnent leur valeur en moyenne et une erreur nulle
+TEST(FilmTest, ConstantSamplesConverge) {
+    pixel_accumulator pixel;
+    for (int i = 0; i < 8; ++i) {
+        pixel.add(color(0.5f, 0.5f, 0.5f));
+    }
+
+    EXPECT_EQ(pixel.count, 8u);
+    EXPECT_FLOAT_EQ(pixel.mean().x(), 0.5f);
+    EXPECT_NEAR(pixel.relative_error(), 0.0f, 1e-4f);
+}
+
+// L'erreur relative décroît avec le nombre d'échantillons
+TEST(FilmTest, ErrorDecreasesWithSamples) {
+    pixel_accumulator few;
+    pixel_accumulator many;
+    for (int i = 0; i < 64; ++i) {
+        color sample = (i % 2 == 0) ? color(1, 1, 1) : color(0, 0, 0);
+        if (i < 4) {
+            few.add(sample);
+        }
+        many.add(sample);
+    }
+
+    EXPECT_GT(few.relative_error(), many.relative_error());
+    EXPECT_FLOAT_EQ(many.mean().y(), 0.5f);
+}
+
+// Fusionner deux passes équivaut à accumuler tous les échantillons
+TEST(FilmTest, MergeAccumulatesPasses) {
+    film accumulation(2, 2);
+    pixel_accumulator pass;
+    pass.add(color(1, 0, 0));
+    accumulation.merge(1, 0, pass);
+    accumulation.merge(1, 0, pass);
+
+    EXPECT_EQ(accumulation.get(1, 0).count, 2u);
+    EXPECT_EQ(accumulation.get(0, 0).count, 0u);
+    EXPECT_FLOAT_EQ(accumulation.resolve().GetPixel(1, 0).x(), 1.0f);
+}
+
+// Un checkpoint relu restitue les accumulateurs ; un fichier corrompu est rejeté
+// Le minimum d'une bande de lignes ignore les pixels hors de la bande
+TEST(FilmTest, MinSampleCountOfRows) {
+    film image(2, 3);
+    pixel_accumulator pixel;
+    pixel.add(color(1, 1, 1));
+    image.set(0, 1, pixel);
+    image.set(1, 1, pixel);
+    pixel.add(color(1, 1, 1));
+    image.set(0, 2, pixel);
+    image.set(1, 2, pixel);
+
+    EXPECT_EQ(image.min_sample_count(), 0u);
+    EXPECT_EQ(image.min_sample_count(1, 3), 1u);
+    EXPECT_EQ(image.min_sample_count(2, 3), 2u);
+    EXPECT_EQ(image.min_sample_count(2, 2), 0u);
+}
+
+TEST(FilmTest, CheckpointRoundTrip) {
+    std::string path = testing::TempDir() + "film_tests.ckpt";
+    film original(3, 2);
+    pixel_accumulator pixel;
+    sample_features features;
+    features.depth = 3.0f;
+    pixel.add(color(0.25f, 0.5f, 1.0f), features);
+    pixel.add(color(0.75f, 0.5f, 0.0f));
+    original.set(2, 1, pixel);
+    ASSERT_TRUE(original.save_checkpoint(path, {7, 16}));
+
+    film restored(3, 2);
+    film_checkpoint_info info;
+    ASSERT_TRUE(restored.load_checkpoint(path, info));
+    EXPECT_EQ(info.seed, 7u);
+    EXPECT_EQ(info.target_samples, 16u);
+    EXPECT_EQ(restored.get(2, 1).count, 2u);
+    EXPECT_FLOAT_EQ(restored.get(2, 1).mean().x(), 0.5f);
+    EXPECT_FLOAT_EQ(restored.get(2, 1).mean_features().depth, 1.5f);
+
+    film wrong_size(2, 2);
+    EXPECT_FALSE(wrong_size.load_checkpoint(path, info));
+
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-1, std::ios::end);
+    file.put('\x7f');
+    file.close();
+    EXPECT_FALSE(restored.load_checkpoint(path, info));
+}
+
+// Un checkpoint fusionné ajoute ses échantillons à ceux du film ; son en-tête se lit seul
+TEST(FilmTest, MergeCheckpointAddsSamples) {
+    std::string path = testing::TempDir() + "film_tests_part.ckpt";
+    film part(2, 1);
+    pixel_accumulator pixel;
+    pixel.add(color(1, 1, 1));
+    part.set(1, 0, pixel);
+    ASSERT_TRUE(part.save_checkpoint(path, {5, 8, 2, 3, 1}));
+
+    unsigned int width = 0;
+    unsigned int height = 0;
+    film_checkpoint_info info;
+    ASSERT_TRUE(film::read_checkpoint_header(path, width, height, info));
+    EXPECT_EQ(width, 2u);
+    EXPECT_EQ(height, 1u);
+    EXPECT_EQ(info.seed, 5u);
+    EXPECT_EQ(info.part_index, 2u);
+    EXPECT_EQ(info.part_count, 3u);
+    EXPECT_EQ(info.part_split, 1u);
+
+    film merged(2, 1);
+    merged.set(1, 0, pixel);
+    ASSERT_TRUE(merged.merge_checkpoint(path, info));
+    EXPECT_EQ(merged.get(1, 0).count, 2u);
+    EXPECT_EQ(merged.get(0, 0).count, 0u);
+
+    film wrong_size(3, 1);
+    EXPECT_FALSE(wrong_size.merge_checkpoint(path, info));
+}
+
+// Film 32 x 16 bruité : moitié gauche d'albédo clair (0.5 en moyenne), moitié droite sombre
+// (0.2). Le débruitage réduit fortement l'erreur sans mélanger les deux moitiés
+TEST(DenoiserTest, ReducesNoiseAndKeepsEdges) {
+    const int width = 32;
+    const int height = 16;
+    film noisy(width, height);
+    uint32_t state = 12345;
+    auto noise = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f - 0.5f;
+    };
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            bool left = x < width / 2;
+            sample_features features;
+            features.albedo = left ? color(0.8f, 0.8f, 0.8f) : color(0.3f, 0.3f, 0.3f);
+            features.normal = vector3(0, 0, 1);
+            features.depth = 2.0f;
+            float truth = left ? 0.5f : 0.2f;
+            pixel_accumulator pixel;
+            for (int s = 0; s < 8; ++s) {
+                float value = truth * (1.0f + 1.5f * noise());
+                pixel.add(color(value, value, value), features);
+            }
+            noisy.set(x, y, pixel);
+        }
+    }
+
+    thread_pool pool(2);
+    Image raw = noisy.resolve();
+    Image denoised = denoise_film(noisy, denoise_options(), &pool);
+    double raw_error = 0.0;
+    double denoised_error = 0.0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float truth = x < width / 2 ? 0.5f : 0.2f;
+            raw_error += std::pow(raw.GetPixel(x, y).x() - truth, 2.0f);
+            denoised_error += std::pow(denoised.GetPixel(x, y).x() - truth, 2.0f);
+        }
+        // Les pixels de part et d'autre de l'arête gardent leur niveau
+        EXPECT_NEAR(denoised.GetPixel(width / 2 - 1, y).x(), 0.5f, 0.05f);
+        EXPECT_NEAR(denoised.GetPixel(width / 2, y).x(), 0.2f, 0.03f);
+    }
+    EXPECT_LT(denoised_error, 0.1 * raw_error);
+
+    // Force nulle : l'image n'est pas modifiée
+    denoise_options off;
+    off.strength = 0.0f;
+    EXPECT_FLOAT_EQ(denoise_film(noisy, off, &pool).GetPixel(3, 4).x(), raw.GetPixel(3, 4).x());
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "core/hitrecord.hpp"
+#include "shape/mesh.hpp"
+
+namespace {
+
+// Écrit un .obj minimal : un triangle dans le plan z = 0. Un fichier par test : ctest -j
+// lance chaque test dans son propre processus
+std::string write_triangle_obj(const std::string& name) {
+    std::string path = testing::TempDir() + name;
+    std::ofstream out(path);
+    out << "v -1 -1 0\n"
+        << "v 1 -1 0\n"
+        << "v 0 1 0\n"
+        << "f 1/1/1 2/2/2 3/3/3\n";
+    return path;
+}
+
+}  // namespace
+
+// Un même fichier n'est lu qu'une fois et la géométrie est partagée
+TEST(MeshCacheTest, LoadsEachFileOnce) {
+    auto path = write_triangle_obj("mesh_tests_cache.obj");
+    mesh_cache::instance().clear();
+
+    auto first = mesh_cache::instance().load(path);
+    auto second = mesh_cache::instance().load(path);
+
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(first->triangles.objects.size(), 1u);
+    EXPECT_EQ(mesh_cache::instance().size(), 1u);
+
+    std::remove(path.c_str());
+}
+
+// Deux chemins vers le même fichier partagent une seule entrée
+TEST(MeshCacheTest, KeysOnCanonicalPath) {
+    auto path = write_triangle_obj("mesh_tests_canonical.obj");
+    std::filesystem::path file(path);
+    std::string detour =
+        (file.parent_path() / "." / file.filename()).string();  // Même fichier, autre chemin
+    mesh_cache::instance().clear();
+
+    auto first = mesh_cache::instance().load(path);
+    auto second = mesh_cache::instance().load(detour);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(mesh_cache::instance().size(), 1u);
+
+    std::remove(path.c_str());
+}
+
+TEST(MeshCacheTest, MissingFileReturnsNull) {
+    EXPECT_EQ(mesh_cache::instance().load("does_not_exist.obj"), nullptr);
+}
+
+// L'échelle et l'origine de l'instance sont appliquées au moment de l'intersection
+TEST(MeshInstanceTest, HitAppliesScaleAndOrigin) {
+    auto path = write_triangle_obj("mesh_tests_instance.obj");
+    auto asset = mesh_cache::instance().load(path);
+    ASSERT_NE(asset, nullptr);
+
+    auto mat = make_shared<lambertian>(color(0.5f, 0.5f, 0.5f));
+    mesh_instance instance(asset, mat, 2.0f, point3(0, 0, -5));
+
+    aabb box = instance.bounding_box();
+    EXPECT_NEAR(box.x.min, -2.0f, 1e-4f);
+    EXPECT_NEAR(box.y.max, 2.0f, 1e-4f);
+
+    HitRecord rec;
+    ray r(point3(0.8f, 0, 0), vector3(0, 0, -1));
+    ASSERT_TRUE(instance.hit(r, interval(0.001f, infinity), rec));
+    EXPECT_NEAR(rec.t, 5.0f, 1e-4f);
+    EXPECT_NEAR(rec.p.z(), -5.0f, 1e-4f);
+    EXPECT_EQ(rec.mat, mat);
+
+    // Hors du triangle mis à l'échelle
+    ray miss(point3(1.5f, 0, 0), vector3(0, 0, -1));
+    EXPECT_FALSE(instance.hit(miss, interval(0.001f, infinity), rec));
+
+    // Requête d'occultation : même repère, l'intervalle est celui du rayon en espace monde
+    EXPECT_TRUE(instance.occluded(r, interval(0.001f, infinity)));
+    EXPECT_FALSE(instance.occluded(r, interval(0.001f, 4.9f)));
+    EXPECT_FALSE(instance.occluded(miss, interval(0.001f, infinity)));
+
+    std::remove(path.c_str());
+}
+
+// Une échelle nulle ou négative est refusée avant le calcul de son inverse
+TEST(MeshInstanceTest, RejectsNonPositiveScale) {
+    auto path = write_triangle_obj("mesh_tests_scale.obj");
+    auto asset = mesh_cache::instance().load(path);
+    ASSERT_NE(asset, nullptr);
+
+    auto mat = make_shared<lambertian>(color(0.5f, 0.5f, 0.5f));
+    EXPECT_THROW(mesh_instance(asset, mat, 0.0f, point3(0, 0, 0)), std::invalid_argument);
+    EXPECT_THROW(mesh_instance(asset, mat, -1.0f, point3(0, 0, 0)), std::invalid_argument);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "sampler.hpp"
+
+namespace {
+
+// Nombre de strates d'une grille n x n contenant au moins un des `count` premiers points
+int occupied_strata(const sampler& s, uint64_t pixel_seed, uint32_t dimension, int count,
+                    int n) {
+    std::set<int> strata;
+    for (int i = 0; i < count; ++i) {
+        sample_2d p = s.get_2d(pixel_seed, static_cast<uint32_t>(i), dimension);
+        EXPECT_GE(p.u, 0.0f);
+        EXPECT_LT(p.u, 1.0f);
+        EXPECT_GE(p.v, 0.0f);
+        EXPECT_LT(p.v, 1.0f);
+        strata.insert(static_cast<int>(p.u * n) * n + static_cast<int>(p.v * n));
+    }
+    return static_cast<int>(strata.size());
+}
+
+}  // namespace
+
+// Les 16 premiers points de Sobol brouillés occupent chacun une case d'une grille 4 x 4,
+// pour toute paire de dimensions et tout pixel
+TEST(SamplerTest, SobolPointsAreStratified) {
+    sobol_sampler sobol;
+    for (uint64_t pixel : {0ull, 1ull, 123456789ull}) {
+        for (uint32_t dimension : {0u, 2u, 10u}) {
+            EXPECT_EQ(occupied_strata(sobol, pixel, dimension, 16, 4), 16);
+            EXPECT_EQ(occupied_strata(sobol, pixel, dimension, 64, 8), 64);
+        }
+    }
+}
+
+TEST(SamplerTest, StratifiedPointsCoverEveryStratum) {
+    stratified_sampler stratified(16);
+    EXPECT_EQ(occupied_strata(stratified, 42, 0, 16, 4), 16);
+    EXPECT_EQ(occupied_strata(stratified, 42, 4, 16, 4), 16);
+}
+
+// Les paires de dimensions et les pixels reçoivent des ensembles de points différents
+TEST(SamplerTest, SobolDimensionsAndPixelsAreDecorrelated) {
+    sobol_sampler sobol;
+    sample_2d a = sobol.get_2d(5, 3, 0);
+    sample_2d b = sobol.get_2d(5, 3, 2);
+    sample_2d c = sobol.get_2d(6, 3, 0);
+    EXPECT_NE(a.u, b.u);
+    EXPECT_NE(a.u, c.u);
+
+    sample_2d again = sobol.get_2d(5, 3, 0);
+    EXPECT_EQ(a.u, again.u);
+    EXPECT_EQ(a.v, again.v);
+}
+
+// La version par lots du générateur à compteur donne exactement les tirages un à un
+TEST(SamplerTest, CounterBatchMatchesScalar) {
+    uint64_t key = counter_key(12345, 7);
+    float batch[37];
+    counter_random_floats(key, 5, batch, 37);
+    for (uint32_t i = 0; i < 37; ++i) {
+        EXPECT_EQ(batch[i], unit_float(counter_random(key, 5 + i)));
+    }
+}
+
+// Tirages à compteur répartis uniformément : 16 classes de fréquences voisines
+TEST(SamplerTest, CounterRandomIsUniform) {
+    const int draws = 1 << 16;
+    int histogram[16] = {};
+    double sum = 0.0;
+    for (int i = 0; i < draws; ++i) {
+        float value = unit_float(counter_random(counter_key(99, static_cast<uint32_t>(i)), 3));
+        ASSERT_GE(value, 0.0f);
+        ASSERT_LT(value, 1.0f);
+        histogram[static_cast<int>(value * 16)]++;
+        sum += value;
+    }
+    EXPECT_NEAR(sum / draws, 0.5, 0.01);
+    for (int count : histogram) {
+        EXPECT_NEAR(count, draws / 16, draws / 16 / 10);
+    }
+}
@@ -0,0 +1,545 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <typeinfo>
+
+#include "core/bvh_node.hpp"
+#include "core/hitrecord.hpp"
+#include "core/hittable_list.hpp"
+#include "core/light.hpp"
+#include "lib/thread_pool.hpp"
+#include "scene/animation.hpp"
+#include "scene/scene.hpp"
+#include "scene/snapshot.hpp"
+#include "shape/mesh.hpp"
+#include "shape/sphere.hpp"
+
+namespace {
+
+std::string write_scene(const std::string& name, const std::string& content) {
+    std::string path = testing::TempDir() + name;
+    std::ofstream out(path);
+    out << content;
+    return path;
+}
+
+const char* basic_scene = R"({
+  "camera": { "note": "ignoré par le chargeur" },
+  "objects": [
+    { "type": "sphere", "center": [0, 0, -2], "radius": 0.5,
+      "material": { "type": "lambertian", "albedo": [0.7, 0.3, 0.3] } },
+    { "type": "triangle", "v0": [-1, 0, -1], "v1": [1, 0, -1], "v2": [0, 1, -1],
+      "material": { "type": "metal", "albedo": [0.8, 0.8, 0.8] } },
+    { "type": "plane", "point": [0, -0.5, 0], "normal": [0, 1, 0] },
+    { "type": "mesh", "file": "missing.obj" }
+  ]
+})";
+
+const char* library_scene = R"({
+  "materials": {
+    "red": { "type": "lambertian", "albedo": [0.7, 0.3, 0.3] },
+    "mirror": { "type": "metal", "albedo": [0.8, 0.8, 0.8] }
+  },
+  "meshes": { "prop": { "file": "missing.obj", "scale": 0.5 } },
+  "objects": [
+    { "type": "sphere", "center": [0, 0, -2], "radius": 0.5, "material": "red" },
+    { "type": "sphere", "center": [1, 0, -2], "radius": 0.5, "material": "red" },
+    { "type": "sphere", "center": [2, 0, -2], "radius": 0.5,
+      "material": { "type": "lambertian", "albedo": [0.70, 0.3, 0.30], "note": "rouge" } },
+    { "type": "sphere", "center": [3, 0, -2], "radius": 0.5,
+      "material": { "type": "metal", "albedo": [0.1, 0.1, 0.1] } },
+    { "type": "sphere", "center": [4, 0, -2], "radius": 0.5,
+      "material": { "albedo": [0.1, 0.1, 0.1], "type": "metal" } },
+    { "type": "mesh", "mesh": "prop", "origin": [0, 0, -4], "material": "mirror" },
+    { "type": "mesh", "mesh": "unknown", "origin": [0, 0, -4], "scale": 2 }
+  ]
+})";
+
+shared_ptr<material> material_of(const hittable_list& world, size_t index) {
+    auto s = std::dynamic_pointer_cast<sphere>(world.objects[index]);
+    return s ? s->get_material() : nullptr;
+}
+
+void expect_shared_materials(const hittable_list& world) {
+    ASSERT_EQ(world.objects.size(), 5u);
+    ASSERT_NE(material_of(world, 0), nullptr);
+    // Référence nommée et description en ligne de mêmes paramètres : une seule instance
+    EXPECT_EQ(material_of(world, 0), material_of(world, 1));
+    EXPECT_EQ(material_of(world, 0), material_of(world, 2));
+    EXPECT_EQ(material_of(world, 3), material_of(world, 4));
+    EXPECT_NE(material_of(world, 0), material_of(world, 3));
+}
+
+}  // namespace
+
+TEST(SceneTest, DomLoaderAddsEveryPrimitive) {
+    auto path = write_scene("scene_tests_basic.json", basic_scene);
+    hittable_list world;
+    load_scene_from_json_file(path, world);
+    EXPECT_EQ(world.objects.size(), 3u);
+    std::remove(path.c_str());
+}
+
+// Le mode streaming doit produire la même scène que le chargement DOM
+TEST(SceneTest, StreamingLoaderMatchesDomLoader) {
+    auto path = write_scene("scene_tests_stream.json", basic_scene);
+    hittable_list dom_world;
+    hittable_list stream_world;
+    load_scene_from_json_file(path, dom_world);
+    stream_scene_from_json_file(path, stream_world);
+
+    ASSERT_EQ(stream_world.objects.size(), dom_world.objects.size());
+    aabb dom_box = dom_world.bounding_box();
+    aabb stream_box = stream_world.bounding_box();
+    EXPECT_EQ(stream_box.x.min, dom_box.x.min);
+    EXPECT_EQ(stream_box.y.max, dom_box.y.max);
+    std::remove(path.c_str());
+}
+
+TEST(SceneTest, NamedLibrariesAndDeduplicatedMaterials) {
+    auto path = write_scene("scene_tests_library.json", library_scene);
+    hittable_list dom_world;
+    hittable_list stream_world;
+    for (hittable_list* world : {&dom_world, &stream_world}) {
+        testing::internal::CaptureStderr();
+        if (world == &dom_world) {
+            load_scene_from_json_file(path, *world);
+        } else {
+            stream_scene_from_json_file(path, *world);
+        }
+        // Mesh nommé inconnu : signalé une seule fois, l'objet est ignoré
+        std::string errors = testing::internal::GetCapturedStderr();
+        size_t first = errors.find("Unknown mesh: unknown");
+        EXPECT_NE(first, std::string::npos);
+        EXPECT_EQ(errors.find("Unknown mesh", first + 1), std::string::npos);
+    }
+
+    expect_shared_materials(dom_world);
+    expect_shared_materials(stream_world);
+    std::remove(path.c_str());
+}
+
+// Les meshes sont chargés en parallèle mais assemblés dans l'ordre du fichier : le monde
+// obtenu est le même avec 1 ou 4 threads
+TEST(SceneTest, LoadedWorldIndependentOfThreadCount) {
+    auto first_mesh = write_scene("scene_tests_threads_a.obj",
+                                  "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\n"
+                                  "f 1/1/1 2/2/2 3/3/3\nf 1/1/1 2/2/2 4/4/4\n"
+                                  "f 1/1/1 3/3/3 4/4/4\nf 2/2/2 3/3/3 4/4/4\n");
+    auto second_mesh = write_scene("scene_tests_threads_b.obj",
+                                   "v -1 -1 0\nv 1 -1 0\nv 0 1 0\nf 1/1/1 2/2/2 3/3/3\n");
+    auto path = write_scene("scene_tests_threads.json", R"({
+      "materials": { "red": { "type": "lambertian", "albedo": [0.7, 0.3, 0.3] } },
+      "objects": [
+        { "type": "mesh", "file": ")" + first_mesh + R"(", "origin": [-1, 0, -3],
+          "material": "red" },
+        { "type": "sphere", "center": [0, 0, -3], "radius": 0.4,
+          "material": { "type": "metal", "albedo": [0.8, 0.8, 0.8] } },
+        { "type": "mesh", "file": ")" + second_mesh + R"(", "origin": [1, 0, -3], "scale": 0.5,
+          "material": { "type": "lambertian", "albedo": [0.2, 0.8, 0.3] } }
+      ]
+    })");
+
+    std::vector<std::string> signatures;
+    int hits = 0;
+    for (unsigned int threads : {1u, 4u}) {
+        thread_pool_options options;
+        options.num_threads = threads;
+        thread_pool::configure(options);
+        mesh_cache::instance().clear();
+
+        hittable_list world;
+        load_scene_from_json_file(path, world);
+        std::ostringstream signature;
+        signature << std::setprecision(9);
+        for (const auto& object : world.objects) {
+            aabb box = object->bounding_box();
+            signature << typeid(*object).name() << " " << box.x.min << " " << box.y.max << "\n";
+        }
+        for (int y = 0; y < 8; ++y) {
+            for (int x = 0; x < 16; ++x) {
+                ray r(point3(0, 0, 0), vector3(-1.5f + 0.2f * x, -0.7f + 0.2f * y, -3));
+                HitRecord rec;
+                if (world.hit(r, interval(0.001f, infinity), rec)) {
+                    signature << rec.t << " " << rec.mat->base_color().y() << " ";
+                    hits++;
+                }
+            }
+        }
+        signatures.push_back(signature.str());
+    }
+
+    EXPECT_NE(signatures[0].find("mesh_instance"), std::string::npos);
+    EXPECT_GT(hits, 10);
+    EXPECT_EQ(signatures[0], signatures[1]);
+    for (const auto& file : {path, first_mesh, second_mesh}) {
+        std::remove(file.c_str());
+    }
+}
+
+TEST(SceneTest, StreamingLoaderRejectsMalformedFile) {
+    auto path = write_scene("scene_tests_broken.json", R"({ "objects": [ { "type": )");
+    hittable_list world;
+    stream_scene_from_json_file(path, world);
+    EXPECT_TRUE(world.objects.empty());
+
+    // Erreur après plusieurs objets valides : aucun n'est ajouté, le monde est inchangé
+    write_scene("scene_tests_broken.json", R"({ "objects": [
+      { "type": "sphere", "center": [0, 0, -2], "radius": 0.5 },
+      { "type": "sphere", "center": [1, 0, -2], "radius": 0.5 },
+      { "type": "plane", "point": [0, -0.5, 0], "normal": [0, 1, 0] },
+      { "type": "sphere", "center": [2, 0, -2] "radius": 0.5 } ] })");
+    world.add(make_shared<sphere>(point3(0, 5, 0), 1.0f, nullptr));
+    stream_scene_from_json_file(path, world);
+    EXPECT_EQ(world.objects.size(), 1u);
+    std::remove(path.c_str());
+}
+
+TEST(SceneTest, MissingFieldIsReported) {
+    // JSON valide mais sphère sans rayon, puis matériau sans albédo : les deux chargeurs
+    // signalent l'erreur au lieu d'abandonner, et le monde reste inchangé
+    for (const char* content : {
+             R"({ "objects": [
+               { "type": "plane", "point": [0, -0.5, 0], "normal": [0, 1, 0] },
+               { "type": "sphere", "center": [0, 0, -1] } ] })",
+             R"({ "objects": [
+               { "type": "sphere", "center": [0, 0, -1], "radius": 0.5,
+                 "material": { "type": "metal", "albedo": [0.8, 0.8] } } ] })"}) {
+        auto path = write_scene("scene_tests_missing_field.json", content);
+        hittable_list world;
+        world.add(make_shared<sphere>(point3(0, 5, 0), 1.0f, nullptr));
+        load_scene_from_json_file(path, world);
+        EXPECT_EQ(world.objects.size(), 1u);
+        stream_scene_from_json_file(path, world);
+        EXPECT_EQ(world.objects.size(), 1u);
+        std::remove(path.c_str());
+    }
+}
+
+namespace {
+
+// Une scène compilée doit donner exactement les mêmes intersections que la scène JSON
+void expect_snapshot_matches(const std::string& scene_path, const std::string& snapshot_path) {
+    hittable_list world;
+    load_scene_from_json_file(scene_path, world);
+    ASSERT_TRUE(write_scene_snapshot(world, snapshot_path));
+
+    auto snapshot = load_scene_snapshot(snapshot_path);
+    ASSERT_NE(snapshot, nullptr);
+    bvh_node reference(world);
+
+    int hits = 0;
+    for (int i = 0; i < 64; ++i) {
+        for (int j = 0; j < 64; ++j) {
+            ray r(point3(0, 0, 0), vector3(-1.0f + i / 32.0f, -1.0f + j / 32.0f, -1.0f));
+            HitRecord expected, actual;
+            bool expected_hit = reference.hit(r, interval(0.001f, infinity), expected);
+            bool actual_hit = snapshot->hit(r, interval(0.001f, infinity), actual);
+            ASSERT_EQ(actual_hit, expected_hit);
+            if (expected_hit) {
+                EXPECT_NEAR(actual.t, expected.t, 1e-5f);
+                EXPECT_EQ(actual.front_face, expected.front_face);
+                hits++;
+            }
+
+            // Les requêtes d'occultation concordent avec l'intersection la plus proche,
+            // y compris sur un segment qui s'arrête avant elle
+            EXPECT_EQ(reference.occluded(r, interval(0.001f, infinity)), expected_hit);
+            EXPECT_EQ(snapshot->occluded(r, interval(0.001f, infinity)), expected_hit);
+            if (expected_hit) {
+                EXPECT_FALSE(reference.occluded(r, interval(0.001f, expected.t * 0.999f)));
+                EXPECT_FALSE(snapshot->occluded(r, interval(0.001f, expected.t * 0.999f)));
+            }
+        }
+    }
+    EXPECT_GT(hits, 100);
+}
+
+}  // namespace
+
+TEST(SnapshotTest, RoundTripMatchesJsonScene) {
+    auto scene_path = write_scene("scene_tests_snapshot.json", basic_scene);
+    std::string snapshot_path = testing::TempDir() + "scene_tests_snapshot.rbs";
+    expect_snapshot_matches(scene_path, snapshot_path);
+    std::remove(scene_path.c_str());
+    std::remove(snapshot_path.c_str());
+}
+
+// Mesh de quelques centaines de triangles : BVH sur plusieurs niveaux, feuilles en espace monde
+TEST(SnapshotTest, RoundTripMatchesMeshScene) {
+    const int n = 12;
+    std::ostringstream obj;
+    for (int y = 0; y <= n; ++y) {
+        for (int x = 0; x <= n; ++x) {
+            obj << "v " << x << " " << y << " " << ((x * 7 + y * 3) % 5) * 0.2f << "\n";
+        }
+    }
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            int a = y * (n + 1) + x + 1;
+            int b = a + 1, c = a + n + 2, d = a + n + 1;
+            obj << "f " << a << "/1/1 " << b << "/1/1 " << c << "/1/1\n";
+            obj << "f " << a << "/1/1 " << c << "/1/1 " << d << "/1/1\n";
+        }
+    }
+    auto mesh_path = write_scene("scene_tests_snapshot_mesh.obj", obj.str());
+    // Origine et échelle quelconques : aucun rayon de la grille ne passe par une arête
+    auto scene_path = write_scene("scene_tests_snapshot_mesh.json", R"({
+      "objects": [
+        { "type": "mesh", "file": ")" + mesh_path + R"(", "origin": [-1.53, -1.47, -3],
+          "scale": 0.23, "material": { "type": "lambertian", "albedo": [0.5, 0.5, 0.5] } },
+        { "type": "sphere", "center": [0.5, 0.5, -2], "radius": 0.3 }
+      ]
+    })");
+    std::string snapshot_path = testing::TempDir() + "scene_tests_snapshot_mesh.rbs";
+    expect_snapshot_matches(scene_path, snapshot_path);
+    for (const auto& file : {mesh_path, scene_path, snapshot_path}) {
+        std::remove(file.c_str());
+    }
+}
+
+// Les primitives émissives restent des sources après compilation
+TEST(SnapshotTest, KeepsEmissivePrimitivesAsLights) {
+    auto scene_path = write_scene("scene_tests_lights.json", R"({
+      "materials": { "lamp": { "type": "diffuse_light", "emission": [4, 4, 4] } },
+      "objects": [
+        { "type": "sphere", "center": [0, 2, -2], "radius": 0.25, "material": "lamp" },
+        { "type": "triangle", "v0": [-1, 3, -1], "v1": [1, 3, -1], "v2": [0, 3, -3],
+          "material": "lamp" },
+        { "type": "sphere", "center": [0, 0, -2], "radius": 0.5,
+          "material": { "type": "lambertian", "albedo": [0.5, 0.5, 0.5] } }
+      ]
+    })");
+    std::string snapshot_path = testing::TempDir() + "scene_tests_lights.rbs";
+
+    hittable_list world;
+    load_scene_from_json_file(scene_path, world);
+    ASSERT_TRUE(write_scene_snapshot(world, snapshot_path));
+    auto snapshot = load_scene_snapshot(snapshot_path);
+    ASSERT_NE(snapshot, nullptr);
+
+    light_list expected, actual;
+    world.add_lights(expected);
+    snapshot->add_lights(actual);
+    EXPECT_EQ(expected.size(), 2u);
+    EXPECT_EQ(actual.size(), 2u);
+    EXPECT_NEAR(actual.total_area(), expected.total_area(), 1e-5f);
+    EXPECT_NEAR(expected.total_area(), 4 * pi * 0.0625f + 2.0f, 1e-4f);
+
+    std::remove(scene_path.c_str());
+    std::remove(snapshot_path.c_str());
+}
+
+TEST(SnapshotTest, RejectsCorruptedFile) {
+    auto scene_path = write_scene("scene_tests_corrupt.json", basic_scene);
+    std::string snapshot_path = testing::TempDir() + "scene_tests_corrupt.rbs";
+
+    hittable_list world;
+    load_scene_from_json_file(scene_path, world);
+    ASSERT_TRUE(write_scene_snapshot(world, snapshot_path));
+
+    auto patch = [&](std::streamoff position, std::ios::seekdir from, char value) {
+        std::fstream file(snapshot_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(position, from);
+        file.put(value);
+    };
+
+    // Un octet modifié dans la table des matériaux n'est détecté que par le checksum,
+    // vérifié à la demande
+    patch(44, std::ios::beg, '\x7f');
+    EXPECT_NE(load_scene_snapshot(snapshot_path), nullptr);
+    EXPECT_EQ(load_scene_snapshot(snapshot_path, true), nullptr);
+
+    // Un indice du BVH hors limites est toujours refusé
+    ASSERT_TRUE(write_scene_snapshot(world, snapshot_path));
+    patch(-1, std::ios::end, '\x7f');
+    EXPECT_EQ(load_scene_snapshot(snapshot_path), nullptr);
+    EXPECT_EQ(load_scene_snapshot("does_not_exist.rbs"), nullptr);
+
+    std::remove(scene_path.c_str());
+    std::remove(snapshot_path.c_str());
+}
+
+// Un rechargement ne reconstruit que les objets modifiés
+TEST(SceneSessionTest, ReloadRebuildsOnlyChangedObjects) {
+    using status = scene_session::reload_status;
+    auto path = write_scene("scene_tests_session.json", library_scene);
+    scene_session session;
+    ASSERT_EQ(session.reload(path), status::changed);
+    EXPECT_EQ(session.get_stats().created, 7u);  // Mesh inconnu compris, sans objet
+    auto first_world = session.get_world().objects;
+
+    // Fichier inchangé : rien à reconstruire
+    EXPECT_EQ(session.reload(path), status::unchanged);
+    EXPECT_EQ(session.get_stats().reused, 7u);
+    EXPECT_EQ(session.get_world().objects, first_world);
+
+    // Une sphère déplacée et la définition d'un matériau nommé modifiée
+    std::string edited = library_scene;
+    edited.replace(edited.find("[4, 0, -2]"), 10, "[5, 0, -2]");
+    edited.replace(edited.find("[0.8, 0.8, 0.8]"), 15, "[0.9, 0.9, 0.9]");
+    write_scene("scene_tests_session.json", edited);
+
+    ASSERT_EQ(session.reload(path), status::changed);
+    EXPECT_EQ(session.get_stats().created, 2u);  // La sphère et le mesh qui utilise "mirror"
+    EXPECT_EQ(session.get_stats().removed, 1u);  // L'ancienne sphère (identifiée par contenu)
+    EXPECT_EQ(session.get_stats().reused, 5u);
+    auto edited_world = session.get_world().objects;
+    ASSERT_EQ(edited_world.size(), 2u);  // Partie stable et objets reconstruits
+
+    // La même sphère déplacée à nouveau : la partie stable du BVH est gardée
+    edited.replace(edited.find("[5, 0, -2]"), 10, "[6, 0, -2]");
+    write_scene("scene_tests_session.json", edited);
+    ASSERT_EQ(session.reload(path), status::changed);
+    EXPECT_EQ(session.get_stats().created, 1u);
+    ASSERT_EQ(session.get_world().objects.size(), 2u);
+    EXPECT_EQ(session.get_world().objects[0], edited_world[0]);
+    EXPECT_NE(session.get_world().objects[1], edited_world[1]);
+
+    HitRecord rec;
+    ray probe(point3(6, 5, -2), vector3(0, -1, 0));
+    EXPECT_TRUE(session.get_world().hit(probe, interval(0.001f, infinity), rec));
+    probe = ray(point3(4, 5, -2), vector3(0, -1, 0));
+    EXPECT_FALSE(session.get_world().hit(probe, interval(0.001f, infinity), rec));
+
+    // Fichier en cours d'écriture : échec distinct de « inchangé », monde conservé
+    write_scene("scene_tests_session.json", R"({ "objects": [ )");
+    auto kept_world = session.get_world().objects;
+    EXPECT_EQ(session.reload(path), status::failed);
+    EXPECT_EQ(session.get_world().objects, kept_world);
+    std::remove(path.c_str());
+}
+
+// JSON valide mais objet incomplet : rechargement refusé, session et monde inchangés
+TEST(SceneSessionTest, ReloadRejectsMissingField) {
+    using status = scene_session::reload_status;
+    auto path = write_scene("scene_tests_session_missing.json", library_scene);
+    scene_session session;
+    ASSERT_EQ(session.reload(path), status::changed);
+    auto first_world = session.get_world().objects;
+
+    // Matériau nommé modifié et sphère sans rayon ajoutée après les objets valides
+    std::string edited = library_scene;
+    edited.replace(edited.find("[0.7, 0.3, 0.3]"), 15, "[0.1, 0.9, 0.1]");
+    edited.insert(edited.rfind(']'), R"(, { "type": "sphere", "center": [0, 0, -1] })");
+    write_scene("scene_tests_session_missing.json", edited);
+    EXPECT_EQ(session.reload(path), status::failed);
+    EXPECT_EQ(session.get_world().objects, first_world);
+
+    // La bibliothèque n'a pas été modifiée : le fichier d'origine est reconnu inchangé
+    write_scene("scene_tests_session_missing.json", library_scene);
+    EXPECT_EQ(session.reload(path), status::unchanged);
+    EXPECT_EQ(session.get_stats().reused, 7u);
+    EXPECT_EQ(session.get_world().objects, first_world);
+    std::remove(path.c_str());
+}
+
+// Séquence animée : seuls les objets déplacés sont recréés, aux positions interpolées
+TEST(SceneSessionTest, AnimationMovesOnlyAnimatedObjects) {
+    auto scene_path = write_scene("scene_tests_animated.json", R"({
+      "objects": [
+        { "id": "ball", "type": "sphere", "center": [0, 0, -2], "radius": 0.5 },
+        { "id": 7, "type": "triangle", "v0": [-1, 0, -4], "v1": [1, 0, -4], "v2": [0, 1, -4] },
+        { "type": "sphere", "center": [3, 0, -2], "radius": 0.5 }
+      ]
+    })");
+    auto animation_path = write_scene("scene_tests_animation.json", R"({
+      "frames": 5,
+      "camera": [ { "frame": 0, "origin": [0, 0, 0], "vfov": 40 },
+                  { "frame": 4, "origin": [4, 0, 0], "look_at": [0, 0, -2], "vfov": 60 } ],
+      "objects": { "ball": [ { "frame": 2, "offset": [0, 0, 0] },
+                             { "frame": 4, "offset": [0, 2, 0] } ] }
+    })");
+
+    animation anim;
+    ASSERT_TRUE(load_animation(animation_path, anim));
+    EXPECT_EQ(anim.frame_count, 5);
+
+    camera cam;
+    anim.place_camera(2, cam);
+    EXPECT_FLOAT_EQ(cam.camera_origin.x(), 2.0f);
+    EXPECT_FLOAT_EQ(cam.vfov, 50.0f);
+    // Visée interpolée entre (0, 0, -1) et (0, 0, -2) depuis l'origine courante
+    EXPECT_FLOAT_EQ(cam.view_direction.x(), -2.0f);
+    EXPECT_FLOAT_EQ(cam.view_direction.z(), -1.5f);
+
+    scene_session session;
+    ASSERT_EQ(session.reload(scene_path), scene_session::reload_status::changed);
+    auto first_world = session.get_world().objects;
+
+    // Avant la première clé, la balle est tenue à sa position d'origine
+    session.apply_offsets(anim.object_offsets(0));
+    EXPECT_FALSE(session.apply_offsets(anim.object_offsets(1)));
+    EXPECT_EQ(session.get_stats().reused, 3u);
+
+    ASSERT_TRUE(session.apply_offsets(anim.object_offsets(3)));
+    EXPECT_EQ(session.get_stats().created, 1u);
+    EXPECT_EQ(session.get_stats().reused, 2u);
+    EXPECT_NE(session.get_world().objects, first_world);
+
+    HitRecord rec;
+    ray up(point3(0, -5, -2), vector3(0, 1, 0));
+    ASSERT_TRUE(session.get_world().hit(up, interval(0.001f, infinity), rec));
+    EXPECT_NEAR(rec.p.y(), 0.5f, 1e-4f);  // Centre en y = 1 à l'image 3
+
+    // Un "id" inconnu est ignoré
+    EXPECT_FALSE(session.apply_offsets(
+        {{"ball", vector3(0, 1, 0)}, {"missing", vector3(1, 0, 0)}}));
+
+    // Seuls les "id" dont le déplacement change sont recréés ; un objet qui n'est plus
+    // animé revient à sa position d'origine
+    ASSERT_TRUE(session.apply_offsets({{"ball", vector3(0, 1, 0)}, {"7", vector3(1, 0, 0)}}));
+    EXPECT_EQ(session.get_stats().created, 1u);
+    EXPECT_EQ(session.get_stats().reused, 2u);
+    ASSERT_TRUE(session.apply_offsets({{"7", vector3(1, 0, 0)}}));
+    EXPECT_EQ(session.get_stats().created, 1u);
+    EXPECT_TRUE(session.get_world().hit(up, interval(0.001f, infinity), rec));
+    EXPECT_FLOAT_EQ(rec.p.y(), -0.5f);
+    EXPECT_FALSE(session.apply_offsets({{"7", vector3(1, 0, 0)}}));
+
+    std::remove(scene_path.c_str());
+    std::remove(animation_path.c_str());
+}
+
+// Une clé de caméra sans direction de visée est refusée
+TEST(SceneSessionTest, AnimationRejectsDegenerateCameraKey) {
+    auto path = write_scene("scene_tests_degenerate.json", R"({
+      "frames": 2,
+      "camera": [ { "frame": 0, "origin": [0, 0, 0] },
+                  { "frame": 1, "origin": [1, 2, 3], "look_at": [1, 2, 3] } ]
+    })");
+    animation anim;
+    anim.frame_count = 7;
+    EXPECT_FALSE(load_animation(path, anim));
+    EXPECT_EQ(anim.frame_count, 7);
+
+    // Deux clés valides dont l'origine passe par la cible à l'image 1 : la direction de
+    // la clé précédente est gardée
+    write_scene("scene_tests_degenerate.json", R"({
+      "frames": 3,
+      "camera": [ { "frame": 0, "origin": [0, 0, 0], "look_at": [2, 0, 0] },
+                  { "frame": 2, "origin": [2, 0, 0], "look_at": [0, 0, 0] } ]
+    })");
+    ASSERT_TRUE(load_animation(path, anim));
+    camera cam;
+    anim.place_camera(1, cam);
+    EXPECT_FLOAT_EQ(cam.camera_origin.x(), 1.0f);
+    EXPECT_FALSE(cam.view_direction.near_zero());
+    EXPECT_GT(cam.view_direction.x(), 0.0f);
+    anim.place_camera(2, cam);
+    EXPECT_LT(cam.view_direction.x(), 0.0f);
+    std::remove(path.c_str());
+}
+
+// Noms des images d'une séquence
+TEST(SceneSessionTest, FrameFilenames) {
+    EXPECT_EQ(frame_filename("frame_####.png", 7), "frame_0007.png");
+    EXPECT_EQ(frame_filename("f#.png", 123), "f123.png");
+    EXPECT_EQ(frame_filename("shot_##_beauty.png", 5), "shot_05_beauty.png");
+    EXPECT_EQ(frame_filename("out.png", 12), "out_0012.png");
+    EXPECT_EQ(frame_filename("out.png", 12345), "out_12345.png");
+    EXPECT_EQ(frame_filename("render.v2/out", 3), "render.v2/out_0003");
+}
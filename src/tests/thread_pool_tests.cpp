@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "thread_pool.hpp"
+
+// Toutes les tâches d'un groupe sont exécutées avant la fin de wait()
+TEST(ThreadPoolTest, RunsEveryTask) {
+    thread_pool pool(4);
+    std::vector<int> values(1000, 0);
+
+    task_group group(pool);
+    for (size_t i = 0; i < values.size(); ++i) {
+        group.run([&values, i] { values[i] = static_cast<int>(i); });
+    }
+    group.wait();
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(values[i], static_cast<int>(i));
+    }
+}
+
+// Un groupe attendu depuis une tâche du même pool ne bloque pas, même avec un seul worker
+TEST(ThreadPoolTest, NestedGroupsDoNotDeadlock) {
+    thread_pool pool(1);
+    std::atomic<int> count(0);
+
+    task_group outer(pool);
+    for (int i = 0; i < 8; ++i) {
+        outer.run([&] {
+            task_group inner(pool);
+            for (int j = 0; j < 8; ++j) {
+                inner.run([&] { count.fetch_add(1); });
+            }
+            inner.wait();
+        });
+    }
+    outer.wait();
+
+    EXPECT_EQ(count.load(), 64);
+}
+
+// Les tâches tournent sur exactement `num_threads` workers, jamais sur le thread qui attend,
+// et chaque worker épinglé est restreint à un seul coeur
+TEST(ThreadPoolTest, HonoursThreadCountAndAffinity) {
+    thread_pool_options options;
+    options.num_threads = 3;
+    options.pin_threads = true;
+    options.numa_aware = true;
+    thread_pool pool(options);
+
+    EXPECT_EQ(pool.size(), 3u);
+    EXPECT_GE(pool.node_count(), 1u);
+    EXPECT_FALSE(pool.owns_current_thread());
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<int> outside_nodes(0);
+    std::atomic<int> not_worker(0);
+    std::atomic<int> not_pinned(0);
+    task_group group(pool);
+    for (int i = 0; i < 64; ++i) {
+        group.run([&] {
+            if (thread_pool::current_node() >= pool.node_count()) {
+                outside_nodes.fetch_add(1);
+            }
+            if (!pool.owns_current_thread()) {
+                not_worker.fetch_add(1);
+            }
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0 ||
+                CPU_COUNT(&set) != 1) {
+                not_pinned.fetch_add(1);
+            }
+#endif
+            // Laisse aux autres workers le temps de prendre des tâches
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        });
+    }
+    group.wait();
+
+    EXPECT_EQ(outside_nodes.load(), 0);
+    EXPECT_EQ(not_worker.load(), 0);
+    EXPECT_EQ(not_pinned.load(), 0);
+    EXPECT_LE(threads.size(), 3u);
+    EXPECT_EQ(threads.count(std::this_thread::get_id()), 0u);
+}
+
+// Une tâche qui lève une exception ne bloque pas le groupe : wait() la relance une fois
+// toutes les tâches terminées, et le destructeur rend la main sans relancer
+TEST(ThreadPoolTest, WaitRethrowsTaskException) {
+    thread_pool pool(2);
+    std::atomic<int> count(0);
+
+    task_group group(pool);
+    for (int i = 0; i < 16; ++i) {
+        group.run([&count, i] {
+            if (i == 5) {
+                throw std::runtime_error("task failed");
+            }
+            count.fetch_add(1);
+        });
+    }
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    EXPECT_EQ(count.load(), 15);
+
+    // L'exception a été consommée : le groupe est réutilisable
+    group.run([&count] { count.fetch_add(1); });
+    EXPECT_NO_THROW(group.wait());
+    EXPECT_EQ(count.load(), 16);
+
+    {
+        task_group abandoned(pool);
+        abandoned.run([] { throw std::runtime_error("ignored"); });
+    }
+}